@@ -0,0 +1,344 @@
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+#include "../include/ABCMethod.h"
+#include "../include/DataLoader.h"
+#include "../include/Logger.h"
+#include "../include/Parameter.h"
+#include "../include/PriceBatch.h"
+#include "../include/RandomEngine.h"
+#include "../include/ScenarioQuery.h"
+#include "../include/TransitionModel.h"
+
+// Microbenchmarks de los caminos críticos del método ABC sobre SKU sintéticos.
+// Argumentos: número de tramos (10 a 1000) y horizonte en días (7 a 365).
+//
+//   ./bench --benchmark_out=bench_results.json --benchmark_out_format=json
+//
+// o `make bench_json` desde el directorio de compilación.
+
+namespace {
+
+const unsigned long long BENCH_SEED = 20240722ULL;
+
+const char* const FEATURE_NAMES[] = {
+    "client_numeric", "vendor_numeric", "year", "month", "day",
+    "sku_count_products", "total_num_count_products", "total_price_products"
+};
+
+// Tramos contiguos de 250 unidades desde 1000; solo uno de cada dos se marca como observado,
+// así la distancia de los precios simulados no es trivialmente cero.
+SKUData makeSyntheticSKU(int intervalCount) {
+    SKUData data;
+    data.sku = "SYN" + std::to_string(intervalCount);
+    for (int i = 0; i < intervalCount; ++i) {
+        double lower = 1000.0 + 250.0 * i;
+        data.listProducts.push_back(std::make_pair(lower, lower + 249.0));
+        if (i % 2 == 0) {
+            PriceInterval interval = {lower, lower + 249.0, 1};
+            data.intervals.push_back(interval);
+        }
+    }
+    data.globalMinPrice = data.listProducts.front().first;
+    data.globalMaxPrice = data.listProducts.back().second;
+    buildIntervalIndex(data);
+    return data;
+}
+
+std::map<std::string, double> makeSyntheticFeatures(int featureCount) {
+    std::map<std::string, double> features;
+    RandomEngine rng(BENCH_SEED);
+    for (int i = 0; i < featureCount; ++i) {
+        std::string name = i < 8 ? FEATURE_NAMES[i] : "feature_" + std::to_string(i);
+        features[name] = rng.uniform(-2.0, 2.0);
+    }
+    return features;
+}
+
+std::vector<Parameter> makeParameters(const std::map<std::string, double>& features) {
+    std::vector<Parameter> parameters;
+    for (const auto& feature : features) {
+        parameters.push_back(Parameter(feature.first, 0.5));
+    }
+    return parameters;
+}
+
+// Archivos temporales en el directorio actual, escritos una vez por tamaño
+std::string writeSKUFile(int intervalCount) {
+    std::string path = "bench_sku_" + std::to_string(intervalCount) + ".csv";
+    FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) {
+        return path;
+    }
+    SKUData data = makeSyntheticSKU(intervalCount);
+    std::fputs("sku", file);
+    for (int i = 0; i < intervalCount; ++i) {
+        std::fprintf(file, ";list_products_%d", i + 1);
+    }
+    std::fprintf(file, ";min_price;max_price\n%s", data.sku.c_str());
+    for (const auto& interval : data.listProducts) {
+        std::fprintf(file, ";(%.0f, %.0f)", interval.first, interval.second);
+    }
+    std::fprintf(file, ";%.0f;%.0f\n", data.globalMinPrice, data.globalMaxPrice);
+    std::fclose(file);
+    return path;
+}
+
+std::string writeFeaturesFile(int featureCount) {
+    std::string path = "bench_features_" + std::to_string(featureCount) + ".txt";
+    FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) {
+        return path;
+    }
+    for (const auto& feature : makeSyntheticFeatures(featureCount)) {
+        std::fprintf(file, "%s: ['216098 (%f)']\n", feature.first.c_str(), feature.second);
+    }
+    std::fclose(file);
+    return path;
+}
+
+void quietLogs() {
+    Logger::setLevel(LogLevel::Warning);
+}
+
+void intervalDayArgs(benchmark::internal::Benchmark* bench) {
+    bench->ArgNames({"intervals", "days"});
+    for (int intervals : {10, 100, 1000}) {
+        for (int days : {7, 30, 90, 365}) {
+            bench->Args({intervals, days});
+        }
+    }
+}
+
+void BM_SimulateFuturePrices(benchmark::State& state) {
+    quietLogs();
+    const SKUData skuData = makeSyntheticSKU(static_cast<int>(state.range(0)));
+    const int days = static_cast<int>(state.range(1));
+    const std::map<std::string, double> features = makeSyntheticFeatures(8);
+    const std::vector<Parameter> parameters = makeParameters(features);
+
+    ABCMethod abcMethod;
+    abcMethod.setSeed(BENCH_SEED);
+    RandomEngine rng(BENCH_SEED);
+
+    // Incluye la construcción del modelo de transición, como en cada propuesta
+    for (auto _ : state) {
+        std::vector<double> prices = abcMethod.simulateFuturePrices(parameters, skuData, features, days, rng);
+        benchmark::DoNotOptimize(prices.data());
+    }
+    state.SetItemsProcessed(state.iterations() * days);
+}
+BENCHMARK(BM_SimulateFuturePrices)->Apply(intervalDayArgs);
+
+// Solo el muestreo diario con un modelo ya construido: debe ser constante en el número de tramos
+void BM_SimulateWithModel(benchmark::State& state) {
+    quietLogs();
+    const SKUData skuData = makeSyntheticSKU(static_cast<int>(state.range(0)));
+    const int days = static_cast<int>(state.range(1));
+    const std::map<std::string, double> features = makeSyntheticFeatures(8);
+
+    TransitionModel model;
+    model.build(skuData, features, makeParameters(features));
+
+    ABCMethod abcMethod;
+    RandomEngine rng(BENCH_SEED);
+
+    for (auto _ : state) {
+        std::vector<double> prices = abcMethod.simulateFuturePrices(model, days, rng);
+        benchmark::DoNotOptimize(prices.data());
+    }
+    state.SetItemsProcessed(state.iterations() * days);
+}
+BENCHMARK(BM_SimulateWithModel)->Apply(intervalDayArgs);
+
+// Lote SoA de 1000 caminos con el mismo modelo; el tercer argumento es el kernel (0 escalar,
+// 1 AVX2 si la CPU lo tiene)
+void BM_SimulatePriceBatch(benchmark::State& state) {
+    quietLogs();
+    const SKUData skuData = makeSyntheticSKU(static_cast<int>(state.range(0)));
+    const int days = static_cast<int>(state.range(1));
+    const SimdLevel level = state.range(2) != 0 ? detectSimdLevel() : SimdLevel::Scalar;
+    const std::map<std::string, double> features = makeSyntheticFeatures(8);
+    const int paths = 1000;
+
+    TransitionModel model;
+    model.build(skuData, features, makeParameters(features));
+
+    RandomEngine rng(BENCH_SEED);
+    PriceBatch batch;
+    for (auto _ : state) {
+        simulateModelPriceBatch(model, paths, days, rng, batch, level);
+        benchmark::DoNotOptimize(batch.prices.data());
+    }
+    state.SetItemsProcessed(state.iterations() * paths * days);
+}
+BENCHMARK(BM_SimulatePriceBatch)
+    ->ArgNames({"intervals", "days", "simd"})
+    ->ArgsProduct({{10, 100, 1000}, {30, 365}, {0, 1}});
+
+void BM_CalculateDistance(benchmark::State& state) {
+    quietLogs();
+    const SKUData skuData = makeSyntheticSKU(static_cast<int>(state.range(0)));
+    const int days = static_cast<int>(state.range(1));
+
+    std::vector<double> prices(days);
+    RandomEngine rng(BENCH_SEED);
+    for (auto& price : prices) {
+        price = rng.uniform(skuData.globalMinPrice, skuData.globalMaxPrice);
+    }
+
+    ABCMethod abcMethod;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(abcMethod.calculateDistance(prices, skuData));
+    }
+    state.SetItemsProcessed(state.iterations() * days);
+}
+BENCHMARK(BM_CalculateDistance)->Apply(intervalDayArgs);
+
+// Simulación y distancia fusionadas con rechazo anticipado. tolerance = 0 simula siempre el
+// camino completo (sin cota); con tolerancias estrictas la mayoría de los caminos se abandona
+// en los primeros días. La métrica skipped es la fracción de días no simulados.
+void BM_SimulateAndScore(benchmark::State& state) {
+    quietLogs();
+    const SKUData skuData = makeSyntheticSKU(static_cast<int>(state.range(0)));
+    const int days = static_cast<int>(state.range(1));
+    const double tolerance = state.range(2) > 0 ? static_cast<double>(state.range(2)) : HUGE_VAL;
+    const std::map<std::string, double> features = makeSyntheticFeatures(8);
+
+    TransitionModel model;
+    model.build(skuData, features, makeParameters(features));
+
+    ABCMethod abcMethod;
+    RandomEngine rng(BENCH_SEED);
+    long long simulated = 0;
+
+    for (auto _ : state) {
+        int simulatedDays;
+        benchmark::DoNotOptimize(abcMethod.simulateAndScore(model, skuData, days, tolerance, rng, &simulatedDays));
+        simulated += simulatedDays;
+    }
+    state.SetItemsProcessed(state.iterations() * days);
+    state.counters["skipped"] = state.iterations() > 0
+                                    ? 1.0 - static_cast<double>(simulated) / (static_cast<double>(state.iterations()) * days)
+                                    : 0.0;
+}
+BENCHMARK(BM_SimulateAndScore)
+    ->ArgNames({"intervals", "days", "tolerance"})
+    ->Args({10, 365, 0})->Args({10, 365, 20})->Args({10, 365, 5})
+    ->Args({100, 365, 0})->Args({100, 365, 20})->Args({100, 365, 5})
+    ->Args({1000, 365, 0})->Args({1000, 365, 5});
+
+// Camino completo (sin cota) con cada métrica: 0 = interval, 1 = histogram, 2 = moments.
+// La métrica se prepara una vez, como en refineParameters.
+void BM_DistanceMetric(benchmark::State& state) {
+    quietLogs();
+    const SKUData skuData = makeSyntheticSKU(static_cast<int>(state.range(0)));
+    const int days = static_cast<int>(state.range(1));
+    const std::map<std::string, double> features = makeSyntheticFeatures(8);
+    const DistanceMetricType metrics[] = {DistanceMetricType::IntervalMiss, DistanceMetricType::Histogram,
+                                          DistanceMetricType::Moments};
+
+    TransitionModel model;
+    model.build(skuData, features, makeParameters(features));
+
+    ABCMethod abcMethod;
+    abcMethod.setDistanceMetric(metrics[state.range(2)]);
+    abcMethod.prepareDistance(skuData);
+    RandomEngine rng(BENCH_SEED);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(abcMethod.simulateAndScore(model, skuData, days, HUGE_VAL, rng));
+    }
+    state.SetItemsProcessed(state.iterations() * days);
+    state.SetLabel(distanceMetricName(metrics[state.range(2)]));
+}
+BENCHMARK(BM_DistanceMetric)
+    ->ArgNames({"intervals", "days", "metric"})
+    ->Args({10, 365, 0})->Args({10, 365, 1})->Args({10, 365, 2})
+    ->Args({100, 365, 0})->Args({100, 365, 1})->Args({100, 365, 2});
+
+// Una ronda completa de 1000 propuestas en un hilo
+void BM_RefineParameters(benchmark::State& state) {
+    quietLogs();
+    const SKUData skuData = makeSyntheticSKU(static_cast<int>(state.range(0)));
+    const int days = static_cast<int>(state.range(1));
+    const std::map<std::string, double> features = makeSyntheticFeatures(8);
+    const std::vector<Parameter> initialParameters = makeParameters(features);
+
+    ABCMethod abcMethod;
+    abcMethod.setSeed(BENCH_SEED);
+    abcMethod.setNumberOfThreads(1);
+
+    for (auto _ : state) {
+        std::vector<Parameter> parameters = initialParameters;
+        abcMethod.refineParameters(parameters, skuData, features, days, 100.0);
+        benchmark::DoNotOptimize(parameters.data());
+    }
+    state.SetItemsProcessed(state.iterations() * 1000);
+}
+BENCHMARK(BM_RefineParameters)
+    ->ArgNames({"intervals", "days"})
+    ->Args({10, 7})->Args({10, 30})->Args({10, 365})
+    ->Args({100, 7})->Args({100, 30})->Args({100, 365})
+    ->Args({1000, 30})
+    ->Unit(benchmark::kMillisecond);
+
+// Una petición del modo consulta sobre un SKU ya calibrado, con una feature cambiada
+void BM_ScenarioQuery(benchmark::State& state) {
+    quietLogs();
+    SKUData skuData = makeSyntheticSKU(static_cast<int>(state.range(0)));
+    const std::map<std::string, double> features = makeSyntheticFeatures(8);
+
+    ScenarioForecaster forecaster;
+    forecaster.setSeed(BENCH_SEED);
+    forecaster.load(skuData, features, makeParameters(features));
+
+    ScenarioRequest request;
+    request.days = static_cast<int>(state.range(1));
+    request.paths = static_cast<int>(state.range(2));
+    request.overrides.push_back(std::make_pair(features.begin()->first, 1.5));
+    ScenarioForecast forecast;
+
+    for (auto _ : state) {
+        forecaster.forecast(request, forecast);
+        benchmark::DoNotOptimize(forecast.median.data());
+    }
+    state.SetItemsProcessed(state.iterations() * request.days * request.paths);
+}
+BENCHMARK(BM_ScenarioQuery)
+    ->ArgNames({"intervals", "days", "paths"})
+    ->Args({10, 30, 1000})->Args({100, 30, 1000})->Args({100, 365, 1000})
+    ->Unit(benchmark::kMicrosecond);
+
+void BM_LoadSKUData(benchmark::State& state) {
+    quietLogs();
+    const std::string path = writeSKUFile(static_cast<int>(state.range(0)));
+
+    for (auto _ : state) {
+        SKUData data = loadSKUData(path);
+        benchmark::DoNotOptimize(data.listProducts.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    std::remove(path.c_str());
+}
+BENCHMARK(BM_LoadSKUData)->ArgName("intervals")->Arg(10)->Arg(100)->Arg(1000);
+
+void BM_LoadNormalizedFeatures(benchmark::State& state) {
+    quietLogs();
+    const std::string path = writeFeaturesFile(static_cast<int>(state.range(0)));
+
+    for (auto _ : state) {
+        std::map<std::string, double> features = loadNormalizedFeatures(path);
+        benchmark::DoNotOptimize(features.size());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    std::remove(path.c_str());
+}
+BENCHMARK(BM_LoadNormalizedFeatures)->ArgName("features")->Arg(8)->Arg(100)->Arg(1000);
+
+} // namespace
+
+BENCHMARK_MAIN();
@@ -5,26 +5,52 @@
 #include <string>
 #include <functional>
 #include <map>
+#include "Arena.h"
+#include "DistanceMetric.h"
+#include "Metrics.h"
 #include "Parameter.h"
+#include "PosteriorSummary.h"
+#include "RandomEngine.h"
+#include "SKUData.h"
+#include "TransitionModel.h"
+#include "WorkerGroup.h"
 
-struct PriceInterval {
-    double minPrice;
-    double maxPrice;
-    int count;
-};
-
-struct SKUData {
-    std::string sku;
-    std::vector<PriceInterval> intervals;
-    double globalMinPrice;
-    double globalMaxPrice;
-    std::vector<std::pair<double, double>> listProducts;
-};
+struct PriceBatch;
 
 class ABCMethod {
 public:
     ABCMethod();
 
+    // Número de hilos usados por refineParameters (0 = todos los núcleos disponibles)
+    void setNumberOfThreads(int threads);
+    int getNumberOfThreads() const;
+
+    // Propuestas simuladas por ronda de refineParameters (1000 por defecto)
+    void setNumberOfSimulations(int simulations);
+    int getNumberOfSimulations() const { return numberOfSimulations; }
+
+    // Instrumentación opcional de las etapas de refineParameters (nullptr = sin métricas)
+    void setMetrics(Metrics* metrics);
+    Metrics* getMetrics() const { return metrics; }
+
+    // Métrica de distancia de refineParameters, simulateAndScore y calculateDistance
+    void setDistanceMetric(DistanceMetricType type);
+    DistanceMetricType getDistanceMetric() const { return distanceMetric; }
+
+    // Con el ajuste activado, refineParameters parte de la media del posterior corregida por
+    // regresión local lineal en lugar de la media simple de las propuestas aceptadas
+    void setRegressionAdjustment(bool enabled);
+    bool getRegressionAdjustment() const;
+
+    // Prepara la métrica para skuData (tramos ordenados, momentos de referencia). Las demás
+    // funciones la reutilizan mientras reciban el mismo skuData; si no, preparan una copia
+    // local en cada llamada. Debe llamarse antes de puntuar desde varios hilos.
+    void prepareDistance(const SKUData& skuData);
+
+    // Semilla maestra; con la misma semilla el posterior no depende del número de hilos
+    void setSeed(unsigned long long seed);
+    unsigned long long getSeed() const;
+
     void initializeParameters(std::vector<Parameter>& parameters);
 
     void refineParameters(std::vector<Parameter>& parameters, 
@@ -33,15 +59,163 @@ public:
                           int daysToSimulate,
                           double tolerance);
                           
-    std::vector<double> simulateFuturePrices(const SKUData& skuData, 
+    // Simula daysToSimulate precios con el modelo de transición de los parámetros dados
+    std::vector<double> simulateFuturePrices(const std::vector<Parameter>& parameters,
+                                             const SKUData& skuData, 
                                              const std::map<std::string, double>& normalizedFeatures,
                                              int daysToSimulate);
 
+    std::vector<double> simulateFuturePrices(const std::vector<Parameter>& parameters,
+                                             const SKUData& skuData, 
+                                             const std::map<std::string, double>& normalizedFeatures,
+                                             int daysToSimulate,
+                                             RandomEngine& rng);
+
+    // Con un modelo ya construido: O(1) por día
+    std::vector<double> simulateFuturePrices(const TransitionModel& model,
+                                             int daysToSimulate,
+                                             RandomEngine& rng);
+
+    // Generador que usarían las versiones sin generador explícito para su siguiente camino;
+    // con él, simulatePricePath sobre un modelo y un buffer propios da los mismos precios
+    RandomEngine nextSimulationEngine();
+
+    // Igual, pero escribe en un buffer de daysToSimulate precios sin reservar memoria
+    void simulatePricePath(const TransitionModel& model,
+                           int daysToSimulate,
+                           RandomEngine& rng,
+                           double* prices);
+
+    // Simula pathCount caminos de daysToSimulate días con el modelo de transición de los
+    // parámetros dados, en un único buffer SoA preasignado
+    void simulatePriceBatch(const std::vector<Parameter>& parameters,
+                            const SKUData& skuData,
+                            const std::map<std::string, double>& normalizedFeatures,
+                            int daysToSimulate,
+                            int pathCount,
+                            PriceBatch& out);
+
+    // Con un modelo ya construido: el camino p es el de simulatePricePath con rng.split(p)
+    void simulatePriceBatch(const TransitionModel& model,
+                            int daysToSimulate,
+                            int pathCount,
+                            const RandomEngine& rng,
+                            PriceBatch& out);
+
+    // Simula y puntúa a la vez, sin guardar los precios. La distancia de cada día se suma
+    // mientras se simula y, si la métrica lo permite, el camino se abandona en cuanto la suma
+    // parcial demuestra que la distancia final superará threshold; en ese caso devuelve una
+    // cota inferior (> threshold). Si no se abandona, el resultado es el mismo que
+    // calculateDistance sobre el camino completo.
+    // simulatedDays (opcional) recibe el número de días simulados y summary (opcional,
+    // PATH_SUMMARY_SIZE valores) los estadísticos de resumen del camino, NaN si se abandonó.
+    double simulateAndScore(const TransitionModel& model,
+                            const SKUData& skuData,
+                            int daysToSimulate,
+                            double threshold,
+                            RandomEngine& rng,
+                            int* simulatedDays = nullptr,
+                            double* summary = nullptr);
+
     double calculateDistance(const std::vector<double>& simulatedPrices, 
                              const SKUData& skuData);
 
+    double calculateDistance(const double* simulatedPrices,
+                             size_t count,
+                             const SKUData& skuData);
+
+    // Distancia normalizada de cada camino de un lote (distances[p] para el camino p)
+    void calculateBatchDistances(const PriceBatch& batch,
+                                 const SKUData& skuData,
+                                 std::vector<double>& distances);
+
+    // Reservas de memoria dinámica del último refineParameters, en todos sus hilos.
+    // Tras la primera ronda debe ser 0; sin ABC_COUNT_ALLOCATIONS siempre lo es.
+    unsigned long long getLastRefineAllocations() const { return lastRefineAllocations; }
+
+    // Copia las propuestas aceptadas en el último refineParameters (una fila de parámetros
+    // por partícula) y sus distancias. Devuelve el número de partículas.
+    int getLastAccepted(std::vector<double>& values, std::vector<double>& distances) const;
+
+    // Media, intervalos de credibilidad y tamaño de muestra efectivo de las aceptadas en el
+    // último refineParameters, en la escala de las probabilidades normalizadas
+    const PosteriorSummary& getLastSummary() const { return lastSummary; }
+
+    // Muestreadores con sus propias poblaciones (ABC-SMC) resumen con el mismo procedimiento
+    PosteriorSummarizer& getSummarizer() { return summarizer; }
+
+    // Hilos persistentes de refineParameters; ABC-SMC reparte en ellos sus intentos
+    WorkerGroup& getWorkers() { return workers; }
+
 private:
     void normalizeParameters(std::vector<Parameter>& parameters);
+
+    // Evalúa las propuestas [firstProposal, lastProposal): la fila i de proposals recibe los
+    // parámetros perturbados y distances[i] la distancia de su simulación (una cota inferior
+    // por encima de la tolerancia si se rechazó antes de terminar el camino)
+    void runProposals(const SKUData& skuData,
+                      int daysToSimulate,
+                      double tolerance,
+                      int firstProposal,
+                      int lastProposal,
+                      unsigned long long round,
+                      int slot,
+                      TransitionModel& model,
+                      double* proposals,
+                      double* distances,
+                      double* summaries);
+
+    // Bucle de runProposals especializado para una métrica
+    template <typename Metric>
+    void runProposalsWith(const Metric& metric,
+                          const SKUData& skuData,
+                          int daysToSimulate,
+                          double tolerance,
+                          int firstProposal,
+                          int lastProposal,
+                          unsigned long long round,
+                          int slot,
+                          TransitionModel& model,
+                          double* proposals,
+                          double* distances,
+                          double* summaries);
+
+    bool isPreparedFor(const SKUData& skuData) const;
+
+    // Estado reutilizado entre rondas de refineParameters
+    ParameterSet parameterSet;
+    FeatureBinding featureBinding;
+    Arena proposalArena;
+    WorkerGroup workers;
+    std::vector<TransitionModel> threadModels;
+    std::vector<unsigned long long> blockAllocations;
+    std::vector<std::vector<double>> threadWorkspaces;
+    std::vector<double> distanceWorkspace;  // calculateDistance, desde un solo hilo
+    unsigned long long lastRefineAllocations;
+
+    // Última ronda, en la arena hasta el siguiente refineParameters
+    const double* lastProposals;
+    const double* lastDistances;
+    int lastProposalCount;
+    double lastTolerance;
+    Metrics* metrics;
+
+    DistanceMetricType distanceMetric;
+    IntervalMissDistance intervalMissDistance;
+    HistogramDistance histogramDistance;
+    MomentDistance momentDistance;
+    const SKUData* preparedSKU;
+    size_t preparedIntervals;
+
+    PosteriorSummarizer summarizer;
+    PosteriorSummary lastSummary;
+
+    int numberOfThreads;
+    int numberOfSimulations;
+    unsigned long long seed;
+    unsigned long long round;
+    unsigned long long simulationCounter;
+    RandomEngine masterEngine;
 };
 
 #endif // ABCMETHOD_H
\ No newline at end of file
@@ -0,0 +1,134 @@
+#ifndef ABCSMC_H
+#define ABCSMC_H
+
+#include <vector>
+#include <string>
+#include <map>
+#include "ABCMethod.h"
+#include "Parameter.h"
+#include "RandomEngine.h"
+#include "TransitionModel.h"
+
+enum class SamplerType {
+    Rejection,
+    SMC
+};
+
+// Motivo por el que ABC-SMC dejó de avanzar
+enum class SMCStopReason {
+    Running,
+    Converged,              // se alcanzó la tolerancia objetivo
+    AcceptanceCollapsed     // la tasa de aceptación cayó por debajo de minAcceptanceRate
+};
+
+struct SMCSettings {
+    int populationSize = 1000;
+    double toleranceQuantile = 0.5;     // tolerancia = cuantil de las distancias de la generación anterior
+    double minAcceptanceRate = 0.01;    // por debajo de esta tasa se detiene el muestreo
+};
+
+// Población ponderada de partículas; values guarda populationSize × dimension en orden por fila
+struct ParticlePopulation {
+    int dimension = 0;
+    std::vector<double> values;
+    std::vector<double> weights;
+    std::vector<double> distances;
+    std::vector<double> summaries;      // PATH_SUMMARY_SIZE estadísticos por partícula (no se guardan en checkpoints)
+    double tolerance = 0.0;
+
+    int size() const { return dimension == 0 ? 0 : static_cast<int>(values.size() / dimension); }
+    const double* particle(int i) const { return values.data() + static_cast<size_t>(i) * dimension; }
+};
+
+// ABC-SMC (Population Monte Carlo, Beaumont et al. 2009) sobre las probabilidades de los parámetros.
+// Prior uniforme en [0, 1] por parámetro, núcleo de perturbación gaussiano con el doble de la
+// varianza ponderada de la población y tolerancia adaptativa tomada de un cuantil de las
+// distancias de la generación anterior.
+class ABCSMC {
+public:
+    ABCSMC(ABCMethod& abcMethod, const SMCSettings& settings);
+
+    // Generación 0: partículas del prior con tolerancia infinita
+    void initialize(const std::vector<Parameter>& parameters,
+                    const SKUData& skuData,
+                    const std::map<std::string, double>& normalizedFeatures,
+                    int daysToSimulate,
+                    double targetTolerance);
+
+    // Generación 0 a partir de una población anterior con la misma dimensión (arranque en
+    // caliente): conserva sus partículas y pesos, y recalcula sus distancias con los datos actuales
+    void initializeFrom(const ParticlePopulation& previous,
+                        const std::vector<Parameter>& parameters,
+                        const SKUData& skuData,
+                        const std::map<std::string, double>& normalizedFeatures,
+                        int daysToSimulate,
+                        double targetTolerance);
+
+    // Avanza una generación. Devuelve false si ya se alcanzó la tolerancia objetivo o si la
+    // tasa de aceptación colapsó; en ese caso la población anterior se conserva.
+    bool step();
+
+    // Solo Converged indica éxito; AcceptanceCollapsed deja la última población completa
+    SMCStopReason getStopReason() const { return stopReason; }
+    bool hasConverged() const { return stopReason == SMCStopReason::Converged; }
+    bool hasStopped() const { return stopReason != SMCStopReason::Running; }
+    int getGeneration() const { return generation; }
+    double getTolerance() const { return population.tolerance; }
+    double getAcceptanceRate() const { return acceptanceRate; }
+    long long getSimulationCount() const { return simulationCount; }
+    const ParticlePopulation& getPopulation() const { return population; }
+
+    // Media ponderada del posterior, escrita en las probabilidades de parameters (la corregida
+    // por regresión si ABCMethod tiene el ajuste activado)
+    void writePosteriorMean(std::vector<Parameter>& parameters) const;
+
+    // Media, intervalos de credibilidad y tamaño de muestra efectivo de la población actual
+    const PosteriorSummary& getPosteriorSummary() const { return posteriorSummary; }
+
+private:
+    struct Attempt {
+        std::vector<double> values;
+        double distance;
+        double summary[PATH_SUMMARY_SIZE];
+        bool accepted;
+    };
+
+    void prepare(const std::vector<Parameter>& parameters,
+                 const SKUData& skuData,
+                 const std::map<std::string, double>& normalizedFeatures,
+                 int daysToSimulate,
+                 double targetTolerance);
+
+    // Deja en attempts los count intentos del lote. Con fixedValues (count filas) las
+    // partículas no se proponen, solo se simulan
+    void evaluateAttempts(int targetGeneration, long long firstAttempt, int count, double tolerance,
+                          const double* fixedValues = nullptr);
+    void proposeFromPopulation(RandomEngine& rng, std::vector<double>& values) const;
+    void computeKernelScales();
+    void summarizePopulation();
+    double kernelDensityMixture(const double* values) const;
+
+    ABCMethod& abcMethod;
+    SMCSettings settings;
+
+    // Tabla de parámetros y features enlazadas una vez; cada hilo reconstruye su propio modelo
+    ParameterSet parameterSet;
+    FeatureBinding featureBinding;
+    std::vector<TransitionModel> threadModels;
+    std::vector<Attempt> attempts;      // se conservan entre lotes y generaciones
+    const SKUData* skuData;
+    int daysToSimulate;
+    double targetTolerance;
+
+    ParticlePopulation population;
+    PosteriorSummary posteriorSummary;
+    std::vector<double> kernelScales;
+    std::vector<double> cumulativeWeights;
+    RandomEngine baseEngine;
+    int generation;
+    double acceptanceRate;
+    long long simulationCount;
+    SMCStopReason stopReason;
+};
+
+#endif // ABCSMC_H
@@ -0,0 +1,33 @@
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+// Contadores de reservas de memoria dinámica, solo en compilaciones instrumentadas
+// (-DABC_COUNT_ALLOCATIONS=ON en cmake). Entonces src/AllocationCounter.cpp reemplaza los
+// operator new/delete globales y cada reserva incrementa un contador global y uno del hilo;
+// sin la opción el asignador global no se toca y los contadores valen siempre 0.
+#ifndef ABC_COUNT_ALLOCATIONS
+#define ABC_COUNT_ALLOCATIONS 0
+#endif
+
+namespace AllocationCounter {
+
+const bool ENABLED = ABC_COUNT_ALLOCATIONS != 0;
+
+#if ABC_COUNT_ALLOCATIONS
+
+// Reservas hechas por el hilo actual desde que empezó
+unsigned long long threadCount();
+
+// Reservas hechas por todo el proceso
+unsigned long long totalCount();
+
+#else
+
+inline unsigned long long threadCount() { return 0; }
+inline unsigned long long totalCount() { return 0; }
+
+#endif
+
+} // namespace AllocationCounter
+
+#endif // ALLOCATIONCOUNTER_H
@@ -0,0 +1,47 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Arena de memoria con asignación por desplazamiento. reset() libera todo de una vez; si
+// durante el ciclo anterior hizo falta más de un bloque, se fusionan en uno solo del tamaño
+// total, de modo que en régimen estable cada ciclo usa un único bloque sin tocar el heap.
+// Solo para tipos triviales: no se llaman constructores ni destructores.
+class Arena {
+public:
+    explicit Arena(size_t initialBytes = 0);
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    template <typename T>
+    T* allocate(size_t count) {
+        return static_cast<T*>(allocateBytes(count * sizeof(T)));
+    }
+
+    void reset();
+
+    // Tras reset(), garantiza un único bloque de al menos bytes (más el margen de alineación
+    // de hasta allocations asignaciones)
+    void reserve(size_t bytes, size_t allocations = 1);
+
+    size_t used() const { return usedBytes; }
+    size_t capacity() const { return capacityBytes; }
+
+private:
+    // Alineación de línea de caché, suficiente también para AVX
+    static const size_t ALIGNMENT = 64;
+
+    void* allocateBytes(size_t bytes);
+    void addBlock(size_t bytes);
+
+    std::vector<std::unique_ptr<unsigned char[]>> blocks;
+    unsigned char* cursor;
+    unsigned char* limit;
+    size_t usedBytes;
+    size_t capacityBytes;
+};
+
+#endif // ARENA_H
@@ -0,0 +1,108 @@
+#ifndef BATCHRUNNER_H
+#define BATCHRUNNER_H
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "DataLoader.h"
+#include "Snapshot.h"
+
+// Par de archivos de entrada de un SKU
+struct SKUJob {
+    std::string sku;
+    std::string intervalsPath;
+    std::string featuresPath;
+};
+
+struct SKUResult {
+    std::string sku;
+    bool succeeded = false;
+    bool skipped = false;           // entradas sin cambios desde el checkpoint
+    double seconds = 0.0;
+    std::string message;
+};
+
+struct BatchSummary {
+    int succeeded = 0;
+    int failed = 0;
+    int skipped = 0;
+    double seconds = 0.0;
+    double skusPerSecond = 0.0;
+    long long steals = 0;
+    int requeued = 0;               // SKU reintentados tras morir su proceso trabajador
+    std::vector<SKUResult> results;
+};
+
+// Semilla de un SKU en un lote con semilla maestra seed: depende solo del id del SKU, no de su
+// posición en el lote ni del proceso que lo calibra
+unsigned long long batchSeedFor(unsigned long long seed, const std::string& sku);
+
+// Manifiesto con una línea "sku;ruta_intervalos;ruta_features" por SKU (se ignoran las líneas con #)
+std::vector<SKUJob> loadSKUManifest(const std::string& filename);
+
+// Cuenta los resultados, calcula el rendimiento y escribe batch_summary.csv en outputDirectory
+void finishBatchSummary(BatchSummary& summary, const std::string& outputDirectory);
+
+// Busca en un directorio los pares matriz_intervals_df_<SKU>_<fecha>.csv y
+// df_features_<SKU>_sku_norm_<fecha>.txt con el mismo SKU y fecha
+std::vector<SKUJob> discoverSKUJobs(const std::string& directory);
+
+// Directorio -> discoverSKUJobs; archivo -> loadSKUManifest
+std::vector<SKUJob> loadSKUJobs(const std::string& path);
+
+// Intervalos de los SKU de un lote. Un archivo de intervalos puede traer varios SKU (una fila por
+// SKU) y aparecer en varias líneas del manifiesto: se lee una sola vez con loadSKUDataset y cada
+// trabajo toma la fila de su SKU. Puede usarse desde varios hilos a la vez.
+class SKUIntervalCache {
+public:
+    // Fila de job.sku en job.intervalsPath. Un archivo de una sola fila vale para su trabajo aunque
+    // la columna sku no coincida con job.sku (discoverSKUJobs toma el SKU del nombre del archivo).
+    // SKUData vacío si el archivo no se pudo leer o no contiene el SKU
+    SKUData load(const SKUJob& job);
+
+private:
+    std::mutex mutex;
+    std::map<std::string, std::map<std::string, SKUData>> files;  // solo archivos con varias filas
+};
+
+// Ejecuta un SimulationEngine por SKU sobre un pool con robo de trabajo y escribe los
+// resultados de cada SKU en outputDirectory (simulation_log_<SKU>.txt y statistics_simulations_<SKU>.txt).
+// Con checkpointDirectory, cada SKU arranca desde checkpoint_<SKU>.bin o se salta si no cambió.
+class BatchRunner {
+public:
+    BatchRunner(const SimulationConfig& config, const std::string& outputDirectory);
+
+    BatchSummary run(const std::vector<SKUJob>& jobs);
+
+    // Todos los SKU de un snapshot; los hilos leen del mismo archivo proyectado
+    BatchSummary run(const SnapshotReader& snapshot);
+
+    // Igual que run(jobs), en tres etapas unidas por colas acotadas: loaderThreads hilos leen
+    // y analizan los SKU siguientes, numberOfThreads hilos calibran con la salida en memoria y
+    // un único hilo escritor guarda log y estadísticas. Cuando una etapa se adelanta, la cola
+    // llena la frena (pipelineQueueCapacity SKU como máximo entre dos etapas).
+    BatchSummary runPipelined(const std::vector<SKUJob>& jobs);
+
+    // Un solo SKU en el hilo actual (lo usan también los procesos de ShardCoordinator)
+    SKUResult runJob(const SKUJob& job) const;
+
+private:
+    template <typename Job>
+    BatchSummary runAll(size_t count, Job job);
+
+    SKUResult runSnapshotJob(const SnapshotReader& snapshot, size_t index) const;
+    bool runEngine(const std::string& sku,
+                   const SKUData& skuData,
+                   const std::map<std::string, double>& normalizedFeatures,
+                   double loadSeconds,
+                   SKUResult& result,
+                   std::string* bufferedLog = nullptr,
+                   std::string* bufferedStats = nullptr) const;
+
+    SimulationConfig config;
+    std::string outputDirectory;
+    mutable SKUIntervalCache intervalCache;
+};
+
+#endif // BATCHRUNNER_H
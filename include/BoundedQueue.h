@@ -0,0 +1,147 @@
+#ifndef BOUNDEDQUEUE_H
+#define BOUNDEDQUEUE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Cola acotada sin bloqueos para varios productores y consumidores (Vyukov). Cada celda lleva
+// un número de secuencia que indica si está libre para la vuelta actual del productor o lista
+// para el consumidor, de modo que push y pop solo compiten por un compare-and-swap.
+//
+// push y pop esperan con espera activa breve, después yield y después pausas cortas: un
+// productor más rápido que su consumidor se frena al llenarse la cola (contrapresión).
+// Tras close(), pop vacía lo pendiente y luego devuelve false.
+template <typename T>
+class BoundedQueue {
+public:
+    // La capacidad se redondea a la siguiente potencia de dos
+    explicit BoundedQueue(size_t capacity)
+        : cells(roundUp(capacity)), mask(cells.size() - 1), head(0), tail(0), closed(false),
+          pushWaits(0), popWaits(0) {
+        for (size_t i = 0; i < cells.size(); ++i) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    bool tryPush(T& value) {
+        size_t position = tail.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[position & mask];
+            const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            const std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+            if (difference == 0) {
+                if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    cell.value = std::move(value);
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (difference < 0) {
+                return false;   // llena
+            } else {
+                position = tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool tryPop(T& value) {
+        size_t position = head.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[position & mask];
+            const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            const std::ptrdiff_t difference =
+                static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position + 1);
+            if (difference == 0) {
+                if (head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    value = std::move(cell.value);
+                    cell.sequence.store(position + mask + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (difference < 0) {
+                return false;   // vacía
+            } else {
+                position = head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Espera mientras la cola esté llena
+    void push(T value) {
+        if (tryPush(value)) {
+            return;
+        }
+        pushWaits.fetch_add(1, std::memory_order_relaxed);
+        for (int attempt = 0; !tryPush(value); ++attempt) {
+            backoff(attempt);
+        }
+    }
+
+    // Espera a que haya un elemento; false si la cola está cerrada y vacía
+    bool pop(T& value) {
+        if (tryPop(value)) {
+            return true;
+        }
+        popWaits.fetch_add(1, std::memory_order_relaxed);
+        for (int attempt = 0;; ++attempt) {
+            if (tryPop(value)) {
+                return true;
+            }
+            if (closed.load(std::memory_order_acquire)) {
+                // Lo encolado antes de close() es visible aquí
+                return tryPop(value);
+            }
+            backoff(attempt);
+        }
+    }
+
+    // Sin más push a partir de aquí
+    void close() { closed.store(true, std::memory_order_release); }
+
+    size_t capacity() const { return cells.size(); }
+
+    // Veces que push encontró la cola llena o pop la encontró vacía
+    long long getPushWaits() const { return pushWaits.load(); }
+    long long getPopWaits() const { return popWaits.load(); }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    static size_t roundUp(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        return size;
+    }
+
+    static void backoff(int attempt) {
+        if (attempt < 64) {
+            return;
+        }
+        if (attempt < 128) {
+            std::this_thread::yield();
+            return;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+
+    std::vector<Cell> cells;
+    const size_t mask;
+    // Índices en líneas de caché distintas: productores y consumidores no se estorban
+    alignas(64) std::atomic<size_t> head;
+    alignas(64) std::atomic<size_t> tail;
+    alignas(64) std::atomic<bool> closed;
+    std::atomic<long long> pushWaits;
+    std::atomic<long long> popWaits;
+};
+
+#endif // BOUNDEDQUEUE_H
@@ -0,0 +1,66 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include "ABCSMC.h"
+#include "SKUData.h"
+
+// Posterior persistido al terminar la calibración de un SKU, para arrancar la del día
+// siguiente desde él (arranque en caliente) o saltarla si las entradas no cambiaron.
+//
+//   char[8] "ABCCKPT\0", uint32 versión, uint32 marca de orden de bytes
+//   uint64 contentHash, uint32 muestreador, int32 iteraciones, double tolerancia
+//   texto sku, uint64 parámetros, por parámetro texto nombre y double probabilidad
+//   int32 dimensión, uint64 partículas, double tolerancia de la población,
+//   double[partículas * dimensión] valores, double[partículas] pesos, double[partículas] distancias
+//
+// Los textos se guardan como uint64 longitud + bytes.
+
+const std::uint32_t CHECKPOINT_VERSION = 1;
+
+struct PosteriorCheckpoint {
+    std::string sku;
+    std::uint64_t contentHash = 0;          // hashCalibrationInputs de las entradas calibradas
+    SamplerType sampler = SamplerType::Rejection;
+    int iterations = 0;                     // iteraciones ejecutadas en esa calibración
+    double tolerance = 0.0;                 // última tolerancia alcanzada
+    std::vector<std::string> parameterNames;
+    std::vector<double> probabilities;
+    // SMC: la población ponderada final; rechazo: las propuestas aceptadas en la última
+    // ronda, con pesos uniformes
+    ParticlePopulation particles;
+};
+
+// Ajustes de una calibración que cambian su posterior. El número de hilos no está: con la
+// misma semilla el resultado no depende de él.
+struct CalibrationSettings {
+    int numberOfIterations = 0;
+    int warmStartIterations = 0;
+    int daysToSimulate = 0;
+    double tolerance = 0.0;
+    int numberOfSimulations = 0;    // propuestas por ronda del muestreo por rechazo
+    bool hasSeed = false;           // sin semilla fija la semilla no entra en el hash
+    unsigned long long seed = 0;
+    SamplerType sampler = SamplerType::Rejection;
+    SMCSettings smc;
+    DistanceMetricType distanceMetric = DistanceMetricType::IntervalMiss;
+    bool regressionAdjustment = false;
+};
+
+// FNV-1a de 64 bits sobre los tramos, los precios extremos y las features del SKU, y sobre
+// todos los ajustes de settings. No depende de la fecha de los archivos de entrada.
+std::uint64_t hashCalibrationInputs(const SKUData& skuData,
+                                    const std::map<std::string, double>& normalizedFeatures,
+                                    const CalibrationSettings& settings);
+
+// Escribe en un temporal y lo renombra: un corte a mitad de la escritura no deja un
+// checkpoint corrupto en path
+bool saveCheckpoint(const std::string& path, const PosteriorCheckpoint& checkpoint);
+
+// Devuelve false sin registrar nada si el archivo no existe; con un aviso si está corrupto
+bool loadCheckpoint(const std::string& path, PosteriorCheckpoint& checkpoint);
+
+#endif // CHECKPOINT_H
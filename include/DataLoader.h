@@ -5,11 +5,50 @@
 #include <string>
 #include <map>
 #include "ABCMethod.h" // Para la definición de SKUData
+#include "ABCSMC.h"
+#include "Logger.h"
+#include "StatsWriter.h"
 
+struct SimulationConfig {
+    int numberOfIterations = 0;
+    double tolerance = 0.0;
+    int daysToSimulate = 0;
+    int numberOfThreads = 1;
+    int numberOfSimulations = 1000; // propuestas por ronda del muestreo por rechazo
+    bool hasSeed = false;           // sin semilla se usa std::random_device
+    unsigned long long seed = 0;
+    SamplerType sampler = SamplerType::Rejection;
+    SMCSettings smc;
+    DistanceMetricType distanceMetric = DistanceMetricType::IntervalMiss;
+    bool regressionAdjustment = false;  // media del posterior corregida por regresión local lineal
+    LogLevel logLevel = LogLevel::Info;
+    std::string logFile;            // vacío: diagnóstico por consola
+    std::string outputDirectory;    // vacío: se usa --output o ../data/output
+    StatsFormat statsFormat = StatsFormat::CSV;
+    bool asyncOutput = false;       // escritura de log y estadísticas en un hilo aparte
+    bool pathHistory = false;       // guarda todos los caminos simulados (simulated_paths.txt)
+    bool metrics = false;           // informe de tiempos por etapa al terminar cada calibración
+    std::string metricsFile;        // vacío: metrics.json en el directorio de salida
+    std::string checkpointDirectory;    // vacío: sin checkpoints; si no, checkpoint_<SKU>.bin por SKU
+    int workerProcesses = 0;        // > 0: el lote se reparte entre procesos (ShardCoordinator)
+    int maxSKUAttempts = 2;         // intentos por SKU si su proceso trabajador muere
+    bool pipeline = false;          // --batch en etapas: carga, calibración y escritura (BatchRunner::runPipelined)
+    int loaderThreads = 2;          // hilos de carga del modo pipeline
+    int pipelineQueueCapacity = 8;  // SKU como máximo en cada cola entre etapas
+    int warmStartIterations = 0;    // iteraciones al arrancar desde un checkpoint (0: numberOfIterations / 4)
+    int queryPaths = 1000;          // caminos por petición de --query que no indica paths
+};
+
+// Lee el primer SKU de un archivo de intervalos
 SKUData loadSKUData(const std::string& filename);
 
+// Lee todos los SKU (una fila por SKU) de un archivo de intervalos en una sola pasada
+std::vector<SKUData> loadSKUDataset(const std::string& filename);
+
 std::map<std::string, double> loadNormalizedFeatures(const std::string& filename);
 
 void loadSimulationConfig(const std::string& filename, int& numberOfIterations, double& tolerance, int& daysToSimulate);
 
+void loadSimulationConfig(const std::string& filename, SimulationConfig& config);
+
 #endif // DATALOADER_H
\ No newline at end of file
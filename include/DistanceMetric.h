@@ -0,0 +1,193 @@
+#ifndef DISTANCEMETRIC_H
+#define DISTANCEMETRIC_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+#include "IntervalIndex.h"
+#include "SKUData.h"
+
+// Distancias ABC entre un camino simulado y los tramos observados de un SKU, como políticas
+// sin funciones virtuales: ABCMethod instancia su bucle de simulación con cada una, de modo
+// que el costo por día queda en línea.
+//
+// Interfaz de una política:
+//   void prepare(const SKUData&)          referencia del SKU; antes de puntuar, fuera de los hilos
+//   size_t workspaceSize() const          doubles de memoria de trabajo que necesita un Accumulator
+//   static const bool incremental         partialSum() sirve para abandonar el camino antes de tiempo
+//   Accumulator(const Policy&, double* workspace)
+//       reset()                           nuevo camino
+//       add(price)                        un día simulado
+//       partialSum()                      cota inferior, que no decrece, de finish(days) * days
+//       finish(days)                      distancia del camino completo
+//   double score(prices, count, workspace) const    distancia de un camino ya simulado
+
+enum class DistanceMetricType {
+    IntervalMiss,       // distancia al tramo más cercano, con penalización fuera del rango global
+    Histogram,          // Wasserstein-1 frente a las frecuencias de los tramos
+    Moments             // diferencia de media y desviación típica
+};
+
+// "interval", "histogram" o "moments"; false si el nombre no es ninguno de ellos
+bool parseDistanceMetric(const std::string& name, DistanceMetricType& type);
+const char* distanceMetricName(DistanceMetricType type);
+
+// Media de las distancias de cada precio al tramo observado más cercano. Un precio fuera de
+// [globalMinPrice, globalMaxPrice] suma además el ancho de ese rango.
+class IntervalMissDistance {
+public:
+    static const bool incremental = true;
+
+    IntervalMissDistance();
+
+    void prepare(const SKUData& skuData);
+    size_t workspaceSize() const { return 0; }
+
+    double cost(double price) const {
+        return index->distance(price) + (price < low || price > high ? range : 0.0);
+    }
+
+    double score(const double* prices, size_t count, double* workspace) const;
+
+    // Suma en totals[j] el costo de prices[j] (un día de todos los caminos de un PriceBatch)
+    void accumulateDay(const double* prices, size_t count, double* totals) const;
+
+    class Accumulator {
+    public:
+        Accumulator(const IntervalMissDistance& metric, double*) : metric(metric), total(0.0) {}
+
+        void reset() { total = 0.0; }
+        void add(double price) { total += metric.cost(price); }
+        double partialSum() const { return total; }
+        double finish(int days) const { return days > 0 ? total / days : 0.0; }
+
+    private:
+        const IntervalMissDistance& metric;
+        double total;
+    };
+
+private:
+    IntervalMissDistance(const IntervalMissDistance&) = delete;
+    IntervalMissDistance& operator=(const IntervalMissDistance&) = delete;
+
+    const IntervalIndex* index;
+    IntervalIndex localIndex;
+    double low;
+    double high;
+    double range;
+};
+
+// Wasserstein-1 entre los precios simulados y la distribución de referencia de los tramos
+// (peso de cada tramo = count / total; pesos iguales si ningún tramo tiene frecuencias).
+// Cada precio se asigna al tramo de centro más cercano y se compara la función de
+// distribución acumulada sobre los centros; a eso se suma la distancia media de los precios a
+// su tramo más cercano, el transporte necesario para llevarlos dentro del soporte observado.
+// Esa segunda parte solo crece, por lo que también permite abandonar caminos.
+class HistogramDistance {
+public:
+    static const bool incremental = true;
+
+    HistogramDistance();
+
+    void prepare(const SKUData& skuData);
+    size_t workspaceSize() const { return centers.size(); }
+
+    size_t bin(double price) const {
+        return static_cast<size_t>(std::upper_bound(boundaries.begin(), boundaries.end(), price) - boundaries.begin());
+    }
+
+    double score(const double* prices, size_t count, double* workspace) const;
+
+    class Accumulator {
+    public:
+        Accumulator(const HistogramDistance& metric, double* workspace)
+            : metric(metric), counts(workspace), miss(0.0), n(0) {}
+
+        void reset() {
+            std::fill(counts, counts + metric.centers.size(), 0.0);
+            miss = 0.0;
+            n = 0;
+        }
+
+        void add(double price) {
+            counts[metric.bin(price)] += 1.0;
+            miss += metric.index->distance(price);
+            ++n;
+        }
+
+        double partialSum() const { return miss; }
+        double finish(int days) const;
+
+    private:
+        const HistogramDistance& metric;
+        double* counts;
+        double miss;
+        long long n;
+    };
+
+private:
+    HistogramDistance(const HistogramDistance&) = delete;
+    HistogramDistance& operator=(const HistogramDistance&) = delete;
+
+    const IntervalIndex* index;
+    IntervalIndex localIndex;
+    std::vector<double> centers;            // centros de los tramos, ordenados
+    std::vector<double> boundaries;         // puntos medios entre centros consecutivos
+    std::vector<double> referenceCDF;       // peso acumulado hasta cada centro
+    std::vector<std::pair<double, double>> weightedCenters;    // (centro, peso) al preparar
+};
+
+// |media simulada - media de referencia| + |desviación simulada - desviación de referencia|,
+// con la referencia tomada como mezcla de uniformes sobre los tramos (mismos pesos que
+// HistogramDistance). Solo se conoce al terminar el camino: no hay abandono anticipado.
+class MomentDistance {
+public:
+    static const bool incremental = false;
+
+    MomentDistance();
+
+    void prepare(const SKUData& skuData);
+    size_t workspaceSize() const { return 0; }
+
+    double score(const double* prices, size_t count, double* workspace) const;
+
+    double getReferenceMean() const { return referenceMean; }
+    double getReferenceDeviation() const { return referenceDeviation; }
+
+    class Accumulator {
+    public:
+        Accumulator(const MomentDistance& metric, double*) : metric(metric), sum(0.0), squares(0.0), n(0) {}
+
+        void reset() {
+            sum = 0.0;
+            squares = 0.0;
+            n = 0;
+        }
+
+        // Desplazado a la media de referencia para no perder precisión al restar
+        void add(double price) {
+            const double deviation = price - metric.referenceMean;
+            sum += deviation;
+            squares += deviation * deviation;
+            ++n;
+        }
+
+        double partialSum() const { return 0.0; }
+        double finish(int days) const;
+
+    private:
+        const MomentDistance& metric;
+        double sum;
+        double squares;
+        long long n;
+    };
+
+private:
+    double referenceMean;
+    double referenceDeviation;
+};
+
+#endif // DISTANCEMETRIC_H
@@ -0,0 +1,59 @@
+#ifndef FASTPARSE_H
+#define FASTPARSE_H
+
+#include <cstddef>
+#include <cstring>
+
+// Utilidades de análisis sin copias sobre un rango [p, end) de caracteres (p. ej. un MappedFile)
+
+inline const char* skipSpaces(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t')) {
+        ++p;
+    }
+    return p;
+}
+
+// Recorta espacios, tabuladores y '\r' al final de [begin, end)
+inline const char* trimRight(const char* begin, const char* end) {
+    while (end > begin && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r')) {
+        --end;
+    }
+    return end;
+}
+
+// Devuelve la posición de c en [p, end), o end si no aparece
+inline const char* findChar(const char* p, const char* end, char c) {
+    const void* found = p < end ? std::memchr(p, c, static_cast<size_t>(end - p)) : nullptr;
+    return found != nullptr ? static_cast<const char*>(found) : end;
+}
+
+// Recorre un buffer línea a línea sin copiar; las líneas no incluyen '\n' ni '\r' final
+class LineReader {
+public:
+    LineReader(const char* begin, const char* end) : pos(begin), end(end) {}
+
+    bool next(const char*& lineBegin, const char*& lineEnd) {
+        if (pos >= end) {
+            return false;
+        }
+        lineBegin = pos;
+        const char* newline = findChar(pos, end, '\n');
+        lineEnd = trimRight(lineBegin, newline);
+        pos = newline < end ? newline + 1 : end;
+        return true;
+    }
+
+private:
+    const char* pos;
+    const char* end;
+};
+
+// Lee un número decimal a partir de p (admite signo, fracción y exponente). Si tiene éxito
+// deja p justo después del número. Los casos habituales (hasta 19 dígitos significativos y
+// exponentes pequeños) se resuelven de forma exacta sin strtod; el resto recurre a strtod.
+bool parseDouble(const char*& p, const char* end, double& value);
+
+// Igual que parseDouble pero exige un entero
+bool parseInt(const char*& p, const char* end, long long& value);
+
+#endif // FASTPARSE_H
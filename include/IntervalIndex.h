@@ -0,0 +1,63 @@
+#ifndef INTERVALINDEX_H
+#define INTERVALINDEX_H
+
+#include <vector>
+#include <cstddef>
+
+struct PriceInterval {
+    double minPrice;
+    double maxPrice;
+    int count;
+};
+
+// Índice ordenado de tramos de precio para calcular en O(log n) la distancia de un precio
+// al tramo más cercano. Los tramos se ordenan y se fusionan si se solapan (la distancia al
+// borde más cercano no cambia), y se guardan en dos arreglos planos con centinelas ±inf,
+// de modo que la búsqueda binaria no necesita ramas ni comprobaciones de límites.
+class IntervalIndex {
+public:
+    IntervalIndex();
+    explicit IntervalIndex(const std::vector<PriceInterval>& intervals);
+
+    void build(const std::vector<PriceInterval>& intervals);
+
+    // Número de tramos con los que se construyó el índice (antes de fusionar)
+    size_t sourceCount() const { return sourceIntervals; }
+    size_t size() const { return lowers.empty() ? 0 : lowers.size() - 2; }
+    bool empty() const { return size() == 0; }
+    bool isBuilt() const { return !lowers.empty(); }
+
+    // Requiere isBuilt(). 0 si el precio cae dentro de algún tramo; si no, distancia al borde más cercano
+    double distance(double price) const {
+        const size_t k = upperBoundSlot(price);
+        const double below = price - uppers[k - 1];
+        const double above = lowers[k] - price;
+        return lowers[k] <= price ? 0.0 : (below < above ? below : above);
+    }
+
+    // Suma de distancias de un bloque de precios; stride permite recorrer una columna SoA
+    double scoreBlock(const double* prices, size_t count, size_t stride = 1) const;
+
+    // Acumula en totals[j] la distancia de prices[j] (un día de un PriceBatch)
+    void accumulateBlock(const double* prices, size_t count, double* totals) const;
+
+private:
+    // Primer índice k (1..size+1) con uppers[k] >= price
+    size_t upperBoundSlot(double price) const {
+        const double* base = uppers.data() + 1;
+        size_t n = uppers.size() - 1;
+        while (n > 1) {
+            const size_t half = n / 2;
+            base = base[half] < price ? base + half : base;
+            n -= half;
+        }
+        base += *base < price;
+        return static_cast<size_t>(base - uppers.data());
+    }
+
+    std::vector<double> lowers;
+    std::vector<double> uppers;
+    size_t sourceIntervals;
+};
+
+#endif // INTERVALINDEX_H
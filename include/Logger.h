@@ -0,0 +1,65 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <cstdio>
+#include <memory>
+#include <sstream>
+#include <string>
+#include "OutputSink.h"
+
+enum class LogLevel {
+    Debug = 0,
+    Info = 1,
+    Warning = 2,
+    Error = 3,
+    Off = 4
+};
+
+// Nivel mínimo compilado: los mensajes por debajo desaparecen del binario (-DABC_LOG_MIN_LEVEL=1 quita Debug)
+#ifndef ABC_LOG_MIN_LEVEL
+#define ABC_LOG_MIN_LEVEL 0
+#endif
+
+// Registro global de diagnóstico. Debug e Info van al sink configurado (stdout por defecto);
+// Warning y Error van a stderr y también al sink configurado, si lo hay.
+class Logger {
+public:
+    static void setLevel(LogLevel level);
+    static LogLevel getLevel();
+
+    static bool isEnabled(LogLevel level) {
+        return static_cast<int>(level) >= ABC_LOG_MIN_LEVEL && static_cast<int>(level) >= currentLevel();
+    }
+
+    // Sustituye el destino de los mensajes (nullptr vuelve a la consola)
+    static void setSink(std::unique_ptr<OutputSink> sink);
+
+    // Consola de Debug e Info sin sink configurado: stdout por defecto; stderr deja stdout
+    // libre para datos (por ejemplo, las respuestas de --query)
+    static void setConsole(FILE* stream);
+
+    static void write(LogLevel level, const std::string& message);
+    static void flush();
+
+private:
+    static int currentLevel();
+};
+
+bool parseLogLevel(const std::string& value, LogLevel& level);
+
+// El mensaje solo se formatea si el nivel está activo; si no, el costo es una comparación
+#define ABC_LOG(level, message)                                                   \
+    do {                                                                          \
+        if (Logger::isEnabled(level)) {                                           \
+            std::ostringstream abcLogStream_;                                     \
+            abcLogStream_ << message;                                             \
+            Logger::write(level, abcLogStream_.str());                            \
+        }                                                                         \
+    } while (0)
+
+#define LOG_DEBUG(message) ABC_LOG(LogLevel::Debug, message)
+#define LOG_INFO(message) ABC_LOG(LogLevel::Info, message)
+#define LOG_WARNING(message) ABC_LOG(LogLevel::Warning, message)
+#define LOG_ERROR(message) ABC_LOG(LogLevel::Error, message)
+
+#endif // LOGGER_H
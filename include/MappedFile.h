@@ -0,0 +1,34 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Archivo de solo lectura proyectado en memoria (mmap). En plataformas sin mmap se lee
+// completo a un buffer, con la misma interfaz.
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& filename);
+    void close();
+
+    bool isOpen() const { return opened; }
+    const char* data() const { return begin; }
+    size_t size() const { return length; }
+    const char* end() const { return begin + length; }
+
+private:
+    const char* begin;
+    size_t length;
+    bool opened;
+    void* mapping;
+    std::vector<char> buffer;
+};
+
+#endif // MAPPEDFILE_H
@@ -0,0 +1,164 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Instrumentación de las etapas críticas de una calibración. Se activa en tiempo de ejecución
+// con setEnabled(true); compilando con -DABC_ENABLE_METRICS=0 los temporizadores y contadores
+// de ABC_METRICS_* desaparecen del binario. Desactivada en tiempo de ejecución, cada punto
+// instrumentado cuesta una comparación.
+#ifndef ABC_ENABLE_METRICS
+#define ABC_ENABLE_METRICS 1
+#endif
+
+enum class MetricStage {
+    Load = 0,
+    Propose,
+    Simulate,
+    Distance,
+    Accept,
+    Count
+};
+
+const char* metricStageName(MetricStage stage);
+
+// Acumuladores de un hilo. alignas redondea el tamaño a un múltiplo de la línea de caché; con
+// el arreglo de Metrics alineado, dos hilos nunca comparten línea.
+struct alignas(64) ThreadMetrics {
+    long long stageNanos[static_cast<int>(MetricStage::Count)];
+    long long stageCalls[static_cast<int>(MetricStage::Count)];
+    long long proposals;
+    long long simulations;
+    long long accepted;
+    long long simulatedDays;
+    long long skippedDays;          // días que el rechazo anticipado no llegó a simular
+
+    ThreadMetrics();
+};
+
+struct IterationMetrics {
+    int iteration;
+    long long proposals;
+    long long accepted;
+    double acceptanceRate;
+    double seconds;
+};
+
+class Metrics {
+public:
+    Metrics();
+
+    Metrics(const Metrics&) = delete;
+    Metrics& operator=(const Metrics&) = delete;
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return enabled; }
+
+    // Prepara un acumulador por hilo; llamar antes de cada región paralela (no reserva si ya alcanza)
+    void reserveThreads(int threads);
+    int threadCount() const { return threadSlots; }
+    const ThreadMetrics& thread(int index) const { return threads[index]; }
+
+    void addStage(int thread, MetricStage stage, long long nanos) {
+        ThreadMetrics& slot = threads[thread];
+        slot.stageNanos[static_cast<int>(stage)] += nanos;
+        ++slot.stageCalls[static_cast<int>(stage)];
+    }
+
+    void addProposal(int thread, bool accepted) {
+        ThreadMetrics& slot = threads[thread];
+        ++slot.proposals;
+        ++slot.simulations;
+        slot.accepted += accepted ? 1 : 0;
+    }
+
+    void addDays(int thread, int simulated, int skipped) {
+        ThreadMetrics& slot = threads[thread];
+        slot.simulatedDays += simulated;
+        slot.skippedDays += skipped;
+    }
+
+    // Cierra una iteración de runSimulations: la tasa de aceptación se calcula con lo
+    // acumulado desde la iteración anterior, salvo que el muestreador la informe
+    void endIteration(int iteration, double seconds, double acceptanceRate = -1.0);
+
+    ThreadMetrics totals() const;
+    const std::vector<IterationMetrics>& getIterations() const { return iterations; }
+
+    // JSON por defecto; si la ruta termina en .prom, formato de texto de Prometheus
+    bool writeReport(const std::string& path, const std::string& sku, const std::string& sampler,
+                     double wallSeconds) const;
+
+private:
+    bool enabled;
+    // Acumuladores por hilo. std::vector solo garantiza la alineación de operator new (16 bytes),
+    // así que el bloque se reserva con una línea de más y el arreglo empieza en la primera frontera
+    std::unique_ptr<unsigned char[]> threadStorage;
+    ThreadMetrics* threads;
+    int threadSlots;
+    std::vector<IterationMetrics> iterations;
+    long long iterationProposals;
+    long long iterationAccepted;
+};
+
+// Temporizador de ámbito: suma al acumulador del hilo el tiempo transcurrido hasta su destrucción
+class MetricTimer {
+public:
+    MetricTimer(Metrics* metrics, int thread, MetricStage stage)
+        : metrics(metrics && metrics->isEnabled() ? metrics : nullptr), thread(thread), stage(stage) {
+        if (this->metrics) {
+            start = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~MetricTimer() {
+        if (metrics) {
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            metrics->addStage(thread, stage, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        }
+    }
+
+    MetricTimer(const MetricTimer&) = delete;
+    MetricTimer& operator=(const MetricTimer&) = delete;
+
+private:
+    Metrics* metrics;
+    int thread;
+    MetricStage stage;
+    std::chrono::steady_clock::time_point start;
+};
+
+#define ABC_METRICS_CONCAT_(a, b) a##b
+#define ABC_METRICS_CONCAT(a, b) ABC_METRICS_CONCAT_(a, b)
+
+#if ABC_ENABLE_METRICS
+#define ABC_METRICS_SCOPE(metrics, thread, stage) \
+    MetricTimer ABC_METRICS_CONCAT(abcMetricTimer_, __LINE__)(metrics, thread, stage)
+#define ABC_METRICS_PROPOSAL(metrics, thread, accepted)       \
+    do {                                                      \
+        if ((metrics) && (metrics)->isEnabled()) {            \
+            (metrics)->addProposal(thread, accepted);         \
+        }                                                     \
+    } while (0)
+#define ABC_METRICS_DAYS(metrics, thread, simulated, skipped)   \
+    do {                                                        \
+        if ((metrics) && (metrics)->isEnabled()) {              \
+            (metrics)->addDays(thread, simulated, skipped);     \
+        }                                                       \
+    } while (0)
+#else
+#define ABC_METRICS_SCOPE(metrics, thread, stage) \
+    do {                                          \
+    } while (0)
+#define ABC_METRICS_PROPOSAL(metrics, thread, accepted) \
+    do {                                                \
+    } while (0)
+#define ABC_METRICS_DAYS(metrics, thread, simulated, skipped) \
+    do {                                                      \
+    } while (0)
+#endif
+
+#endif // METRICS_H
@@ -0,0 +1,125 @@
+#ifndef OUTPUTSINK_H
+#define OUTPUTSINK_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Destino de salida intercambiable (archivo, consola, hilo escritor, nada)
+class OutputSink {
+public:
+    virtual ~OutputSink() {}
+    virtual void write(const char* data, size_t size) = 0;
+    virtual void flush() {}
+    virtual bool good() const { return true; }
+};
+
+// Archivo con un buffer grande de stdio; solo vacía al cerrar o con flush()
+class FileSink : public OutputSink {
+public:
+    explicit FileSink(const std::string& path, size_t bufferSize = 1 << 20);
+    ~FileSink();
+
+    void write(const char* data, size_t size) override;
+    void flush() override;
+    bool good() const override { return file != nullptr; }
+
+private:
+    FILE* file;
+    std::vector<char> buffer;
+};
+
+// stdout o stderr
+class ConsoleSink : public OutputSink {
+public:
+    explicit ConsoleSink(FILE* stream) : stream(stream) {}
+
+    void write(const char* data, size_t size) override { std::fwrite(data, 1, size, stream); }
+    void flush() override { std::fflush(stream); }
+
+private:
+    FILE* stream;
+};
+
+class NullSink : public OutputSink {
+public:
+    void write(const char*, size_t) override {}
+};
+
+// Acumula en un texto ajeno (no lo posee), para escribirlo después desde otro hilo
+class MemorySink : public OutputSink {
+public:
+    explicit MemorySink(std::string* target) : target(target) {}
+
+    void write(const char* data, size_t size) override { target->append(data, size); }
+
+private:
+    std::string* target;
+};
+
+// Acumula en memoria y delega la escritura real a un hilo propio (doble buffer), de modo que
+// el hilo que simula nunca espera al disco salvo que el escritor vaya maxPending bytes por detrás.
+class AsyncSink : public OutputSink {
+public:
+    explicit AsyncSink(std::unique_ptr<OutputSink> target, size_t maxPending = 8 << 20);
+    ~AsyncSink();
+
+    void write(const char* data, size_t size) override;
+    void flush() override;
+    bool good() const override { return target->good(); }
+
+private:
+    void writerLoop();
+
+    std::unique_ptr<OutputSink> target;
+    size_t maxPending;
+    std::vector<char> pending;
+    std::mutex mutex;
+    std::condition_variable dataReady;
+    std::condition_variable drained;
+    bool writing;
+    bool stopping;
+    std::thread writer;
+};
+
+// Abre un archivo de salida, opcionalmente con hilo escritor
+std::unique_ptr<OutputSink> openFileSink(const std::string& path, bool async);
+
+// std::ostream sobre un OutputSink, para seguir usando operator<< al escribir
+class SinkStream : public std::ostream {
+public:
+    explicit SinkStream(std::unique_ptr<OutputSink> sink);
+    ~SinkStream();
+
+    bool isOpen() const { return sink && sink->good(); }
+    void close();
+
+private:
+    class Buffer : public std::streambuf {
+    public:
+        explicit Buffer(OutputSink* sink);
+
+    protected:
+        int_type overflow(int_type c) override;
+        int sync() override;
+        std::streamsize xsputn(const char* data, std::streamsize size) override;
+
+    private:
+        void drain();
+
+        OutputSink* sink;
+        char storage[8192];
+    };
+
+    std::unique_ptr<OutputSink> sink;
+    Buffer buffer;
+};
+
+#endif // OUTPUTSINK_H
@@ -2,6 +2,8 @@
 #define PARAMETER_H
 
 #include <string>
+#include <vector>
+#include <map>
 
 class Parameter {
 public:
@@ -12,4 +14,33 @@ public:
     void adjustProbability(double adjustment);
 };
 
-#endif // PARAMETER_H
\ No newline at end of file
+// Conjunto de parámetros separado en una tabla de nombres internados y un arreglo plano de
+// probabilidades. Los nombres solo se copian cuando cambian, así sincronizar en cada ronda
+// con un std::vector<Parameter> no reserva memoria.
+class ParameterSet {
+public:
+    ParameterSet();
+
+    void assign(const std::vector<Parameter>& parameters);
+    void writeTo(std::vector<Parameter>& parameters) const;
+
+    int size() const { return static_cast<int>(names.size()); }
+    const std::string& name(int i) const { return names[i]; }
+
+    // -1 si el nombre no está en la tabla
+    int indexOf(const std::string& name) const;
+
+    double* probabilities() { return values.data(); }
+    const double* probabilities() const { return values.data(); }
+
+    // Cambia cada vez que cambia la tabla de nombres
+    unsigned long long getLayoutVersion() const { return layoutVersion; }
+
+private:
+    std::vector<std::string> names;
+    std::map<std::string, int> nameIndex;
+    std::vector<double> values;
+    unsigned long long layoutVersion;
+};
+
+#endif // PARAMETER_H
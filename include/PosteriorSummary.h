@@ -0,0 +1,78 @@
+#ifndef POSTERIORSUMMARY_H
+#define POSTERIORSUMMARY_H
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// Estadísticos de resumen de cada camino simulado, medidos respecto a la referencia del SKU
+// (el valor observado es 0): media del camino - media de referencia y desviación típica del
+// camino - desviación de referencia. La distancia ABC es un tercer estadístico.
+const int PATH_SUMMARY_SIZE = 2;
+
+struct PosteriorSummary {
+    int samples = 0;
+    double effectiveSampleSize = 0.0;   // (Σw)² / Σw²
+    bool adjusted = false;              // true si se aplicó el ajuste por regresión
+    std::vector<double> mean;           // por parámetro
+    std::vector<double> lower;          // intervalo de credibilidad
+    std::vector<double> upper;
+
+    // Multiplica media e intervalos (por ejemplo, al normalizar las probabilidades)
+    void scale(double factor);
+};
+
+// Resume las muestras aceptadas de una ronda: media ponderada, intervalos de credibilidad y
+// tamaño de muestra efectivo. Con el ajuste activado aplica la regresión local lineal de
+// Beaumont, Zhang y Balding (2002): cada muestra pesa según un núcleo de Epanechnikov sobre
+// su distancia (ancho = tolerancia) y se corrige con θ* = θ - β (s - s_obs), donde β sale de
+// mínimos cuadrados ponderados de los parámetros sobre los estadísticos de resumen
+// estandarizados. Las muestras ajustadas se recortan a [0, 1].
+//
+// Los buffers se conservan entre llamadas: con el mismo número de muestras no reserva memoria.
+class PosteriorSummarizer {
+public:
+    PosteriorSummarizer();
+
+    void setRegressionAdjustment(bool enabled) { regressionAdjustment = enabled; }
+    bool getRegressionAdjustment() const { return regressionAdjustment; }
+
+    // Masa de los intervalos de credibilidad (0.95 por defecto)
+    void setCredibleMass(double mass);
+
+    // Nueva ronda de muestras de dimension parámetros; expectedCount reserva para ese número
+    // de muestras, de modo que las rondas siguientes no reservan memoria
+    void begin(int dimension, int expectedCount = 0);
+
+    // values: dimension parámetros; summary: PATH_SUMMARY_SIZE estadísticos; weight: peso previo
+    // (importancia en ABC-SMC, 1 en el muestreo por rechazo)
+    void add(const double* values, const double* summary, double distance, double weight);
+
+    // Calcula el resumen de las muestras añadidas desde begin
+    const PosteriorSummary& finish(double bandwidth);
+
+    const PosteriorSummary& getSummary() const { return summary; }
+
+private:
+    bool fitRegression();
+    void weightedQuantiles(int d);
+
+    bool regressionAdjustment;
+    double credibleMass;
+    int dimension;
+    int count;
+
+    std::vector<double> values;         // count × dimension; ajustados tras finish
+    std::vector<double> summaries;      // count × (PATH_SUMMARY_SIZE + 1), con la distancia al final
+    std::vector<double> distances;
+    std::vector<double> weights;
+    std::vector<double> design;         // count × columns: 1 y estadísticos estandarizados
+    std::vector<double> gram;           // columns × columns
+    std::vector<double> crossProducts;  // columns × dimension
+    std::vector<std::pair<double, double>> column;     // (valor, peso) de un parámetro
+    int columns;
+
+    PosteriorSummary summary;
+};
+
+#endif // POSTERIORSUMMARY_H
@@ -0,0 +1,47 @@
+#ifndef PRICEBATCH_H
+#define PRICEBATCH_H
+
+#include <vector>
+#include "ABCMethod.h"
+#include "RandomEngine.h"
+#include "TransitionModel.h"
+
+// Lote de trayectorias de precios en formato SoA: el precio del camino p en el día d
+// está en prices[d * pathCount + p], de modo que un mismo día de todos los caminos es contiguo.
+struct PriceBatch {
+    int pathCount = 0;
+    int dayCount = 0;
+    std::vector<double> prices;
+
+    // Solo reasigna memoria si el lote crece; reutilizar el mismo PriceBatch evita asignaciones
+    void resize(int paths, int days) {
+        pathCount = paths;
+        dayCount = days;
+        prices.resize(static_cast<size_t>(paths) * days);
+    }
+
+    double* day(int d) { return prices.data() + static_cast<size_t>(d) * pathCount; }
+    const double* day(int d) const { return prices.data() + static_cast<size_t>(d) * pathCount; }
+
+    double at(int path, int d) const { return prices[static_cast<size_t>(d) * pathCount + path]; }
+};
+
+enum class SimdLevel {
+    Scalar,
+    AVX2
+};
+
+// Nivel SIMD disponible en la CPU actual
+SimdLevel detectSimdLevel();
+
+// Simula pathCount × daysToSimulate precios con el modelo de transición. El camino p usa el
+// subflujo rng.split(p) y coincide con simulatePricePath sobre ese generador; el resultado es
+// idéntico con el kernel escalar y con AVX2.
+void simulateModelPriceBatch(const TransitionModel& model,
+                             int pathCount,
+                             int daysToSimulate,
+                             const RandomEngine& rng,
+                             PriceBatch& out,
+                             SimdLevel level);
+
+#endif // PRICEBATCH_H
@@ -0,0 +1,78 @@
+#ifndef RANDOMENGINE_H
+#define RANDOMENGINE_H
+
+#include <cstdint>
+
+// Generador xoshiro256** con subflujos derivables.
+// Cumple UniformRandomBitGenerator, por lo que sirve con las distribuciones de <random>.
+// Un subflujo se obtiene con split(id): la clave del flujo hijo es un hash (splitmix64)
+// de la clave del padre y del identificador, de modo que cada ronda, propuesta, día o hilo
+// puede tener su propio flujo sin estado compartido y sin inicializar un mt19937 de 5 KB.
+class RandomEngine {
+public:
+    typedef std::uint64_t result_type;
+
+    explicit RandomEngine(std::uint64_t seed = 0);
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return ~static_cast<result_type>(0); }
+
+    result_type operator()() {
+        const std::uint64_t result = rotl(state[1] * 5, 7) * 9;
+        const std::uint64_t t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 45);
+        return result;
+    }
+
+    // Uniforme en [0, 1) con 53 bits de mantisa
+    double uniform() {
+        return static_cast<double>((*this)() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    double uniform(double a, double b) {
+        return a + (b - a) * uniform();
+    }
+
+    // Entero uniforme en [0, n) sin sesgo (método de Lemire): multiplicación y desplazamiento,
+    // rechazando los pocos valores que harían unos resultados más probables que otros
+    std::uint32_t uniformIndex(std::uint32_t n) {
+        std::uint64_t product = ((*this)() >> 32) * n;
+        std::uint32_t low = static_cast<std::uint32_t>(product);
+        if (low < n) {
+            const std::uint32_t threshold = (0u - n) % n;
+            while (low < threshold) {
+                product = ((*this)() >> 32) * n;
+                low = static_cast<std::uint32_t>(product);
+            }
+        }
+        return static_cast<std::uint32_t>(product >> 32);
+    }
+
+    RandomEngine split(std::uint64_t streamId) const;
+
+    std::uint64_t getKey() const { return key; }
+
+    // Copia el estado interno (lo usan los kernels SIMD que avanzan varios flujos en paralelo)
+    void copyState(std::uint64_t out[4]) const {
+        for (int i = 0; i < 4; ++i) {
+            out[i] = state[i];
+        }
+    }
+
+private:
+    static std::uint64_t rotl(std::uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    void seedFromKey(std::uint64_t key);
+
+    std::uint64_t state[4];
+    std::uint64_t key;
+};
+
+#endif // RANDOMENGINE_H
@@ -0,0 +1,24 @@
+#ifndef SKUDATA_H
+#define SKUDATA_H
+
+#include <vector>
+#include <string>
+#include <utility>
+#include "IntervalIndex.h"
+
+struct SKUData {
+    std::string sku;
+    std::vector<PriceInterval> intervals;
+    double globalMinPrice;
+    double globalMaxPrice;
+    std::vector<std::pair<double, double>> listProducts;
+    IntervalIndex intervalIndex;    // se construye una vez a partir de intervals
+};
+
+// Reconstruye skuData.intervalIndex a partir de skuData.intervals
+void buildIntervalIndex(SKUData& skuData);
+
+// Índice precalculado del SKU; si no corresponde a los tramos actuales se construye en scratch
+const IntervalIndex& intervalIndexFor(const SKUData& skuData, IntervalIndex& scratch);
+
+#endif // SKUDATA_H
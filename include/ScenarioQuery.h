@@ -0,0 +1,118 @@
+#ifndef SCENARIOQUERY_H
+#define SCENARIOQUERY_H
+
+#include <istream>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include "OutputSink.h"
+#include "Parameter.h"
+#include "RandomEngine.h"
+#include "SKUData.h"
+#include "TransitionModel.h"
+
+// Pronóstico bajo un escenario: features que cambian respecto a las calibradas (valores
+// normalizados, como en el archivo de features), horizonte y número de caminos
+struct ScenarioRequest {
+    std::string id;
+    std::vector<std::pair<std::string, double>> overrides;
+    int days = 0;
+    int paths = 0;
+    bool hasSeed = false;           // sin semilla cada petición usa un subflujo nuevo
+    unsigned long long seed = 0;
+};
+
+// Bandas por día de los caminos simulados: media y cuantiles 5%, 50% y 95%
+struct ScenarioForecast {
+    std::string id;
+    int days = 0;
+    int paths = 0;
+    double drift = 0.0;             // deriva del modelo de transición del escenario
+    std::vector<double> mean;
+    std::vector<double> lower;
+    std::vector<double> median;
+    std::vector<double> upper;
+    double seconds = 0.0;
+};
+
+// Una petición por línea, en pares clave=valor separados por espacios:
+//   id=q1 days=90 paths=2000 seed=7 vendor_numeric=-0.2 year=1.9
+// Las claves que no son id, days, paths ni seed son features. Sin days ni paths se usan los
+// valores por defecto. false con el motivo en error si la línea no es válida.
+bool parseScenarioRequest(const std::string& line, int defaultDays, int defaultPaths,
+                          ScenarioRequest& request, std::string& error);
+
+// Responde pronósticos a partir de un SKU ya calibrado sin volver a calibrar. El modelo de
+// transición de las features calibradas se construye una vez en load; una petición con
+// features cambiadas reconstruye solo la copia de trabajo.
+//
+// Cada camino simula solo la cadena de tramos y cuenta por día en qué tramo está. Como el
+// precio dentro de un tramo es uniforme, la distribución de un día es la mezcla de uniformes
+// con esas frecuencias: su media y sus cuantiles se calculan de forma exacta (Rao-Blackwell)
+// con un barrido por los extremos de los tramos, ordenados una vez en load. No se sortea el
+// precio ni se ordenan caminos, y la varianza es menor que la de los cuantiles empíricos.
+// Los buffers se conservan entre peticiones: con el mismo tamaño no se reserva memoria.
+class ScenarioForecaster {
+public:
+    ScenarioForecaster();
+
+    // Estado calibrado: datos del SKU, features normalizadas y probabilidades del posterior
+    bool load(const SKUData& skuData,
+              const std::map<std::string, double>& normalizedFeatures,
+              const std::vector<Parameter>& parameters);
+
+    void setSeed(unsigned long long seed);
+
+    const std::string& getSKU() const { return skuData.sku; }
+
+    // false con un aviso si la petición no es válida (feature sin parámetro calibrado,
+    // horizonte o caminos fuera de rango)
+    bool forecast(const ScenarioRequest& request, ScenarioForecast& result);
+
+private:
+    // Extremo de un tramo; un tramo de ancho 0 es un único punto con masa
+    struct Breakpoint {
+        double price;
+        int interval;
+        int kind;                   // +1 inicio, -1 fin, 0 punto
+    };
+
+    // Media y cuantiles del día con las frecuencias counts (tantas como tramos)
+    void mixtureBands(const int* counts, int paths, double& mean, double* quantiles) const;
+
+    SKUData skuData;
+    ParameterSet parameters;
+    FeatureBinding calibratedFeatures;
+    FeatureBinding scenarioFeatures;
+    TransitionModel calibratedModel;
+    TransitionModel scenarioModel;
+
+    std::vector<Breakpoint> breakpoints;    // ordenados por precio
+    std::vector<double> densities;          // 1 / ancho de cada tramo (0 si es un punto)
+    std::vector<double> midpoints;
+
+    RandomEngine masterEngine;
+    unsigned long long queryCounter;
+    std::vector<int> counts;                // días × tramos
+    bool loaded;
+};
+
+struct ScenarioServeSummary {
+    int answered = 0;
+    int failed = 0;
+    double totalSeconds = 0.0;      // suma de las latencias de las peticiones respondidas
+    double maxSeconds = 0.0;
+};
+
+// Lee peticiones de input hasta el final y escribe en output una fila CSV por día
+// (Query,Day,Mean,Lower,Median,Upper) tras una cabecera. Vacía output después de cada
+// petición, de modo que sirve para un flujo interactivo por stdin. Las líneas vacías y las
+// que empiezan por '#' se ignoran.
+ScenarioServeSummary serveScenarioQueries(ScenarioForecaster& forecaster,
+                                          std::istream& input,
+                                          OutputSink& output,
+                                          int defaultDays,
+                                          int defaultPaths);
+
+#endif // SCENARIOQUERY_H
@@ -0,0 +1,63 @@
+#ifndef SHARDCOORDINATOR_H
+#define SHARDCOORDINATOR_H
+
+#include <string>
+#include <vector>
+#include "BatchRunner.h"
+#include "DataLoader.h"
+
+struct ShardSettings {
+    int workers = 2;                // procesos trabajadores
+    int maxAttempts = 2;            // intentos por SKU cuando su trabajador muere a mitad
+};
+
+// Reparte los SKU de un lote entre procesos trabajadores independientes. Cada trabajador es
+// una nueva ejecución del programa (fork + exec) conectada por un socket local, que calibra un
+// SKU cada vez con BatchRunner::runJob y escribe sus archivos en outputDirectory/shard_<n>.
+//
+// Protocolo por líneas con campos separados por tabuladores:
+//   coordinador -> trabajador   JOB <id> <sku> <ruta_intervalos> <ruta_features>
+//   trabajador -> coordinador   DONE <id> <ok|skipped|failed> <segundos> <mensaje>
+// El trabajador termina cuando el coordinador cierra el socket.
+//
+// Al recibir DONE, los archivos *_<SKU>.* del directorio del trabajador se mueven a
+// outputDirectory, de modo que allí solo aparecen SKU terminados. Si un trabajador muere
+// (señal o salida inesperada), su SKU vuelve a la cola hasta maxAttempts veces y se arranca
+// otro trabajador en su lugar; un SKU que sigue tumbando procesos queda como fallido sin
+// detener el resto del lote.
+class ShardCoordinator {
+public:
+    // workerCommand: argv que arranca el programa en modo trabajador; se le añaden
+    // "--worker-fd <fd> --output <directorio del trabajador>"
+    ShardCoordinator(const std::vector<std::string>& workerCommand,
+                     const std::string& outputDirectory,
+                     const ShardSettings& settings);
+
+    // Escribe batch_summary.csv como BatchRunner::run
+    BatchSummary run(const std::vector<SKUJob>& jobs);
+
+private:
+    struct Worker {
+        int slot;
+        int pid;
+        int fd;
+        int job;                    // SKU en curso (-1 = libre)
+        std::string buffer;         // línea incompleta recibida
+        std::string directory;
+    };
+
+    bool spawn(int slot, Worker& worker);
+    bool dispatch(Worker& worker, const SKUJob& job, int id);
+    // Cierra el socket y recoge el proceso; devuelve la causa de la terminación
+    std::string reap(Worker& worker);
+    void publish(const Worker& worker, const std::string& sku, bool keep);
+
+    std::vector<std::string> workerCommand;
+    std::string outputDirectory;
+    ShardSettings settings;
+};
+
+// Bucle de un proceso trabajador sobre el socket fd; devuelve el código de salida del proceso
+int runShardWorker(const SimulationConfig& config, const std::string& outputDirectory, int fd);
+
+#endif // SHARDCOORDINATOR_H
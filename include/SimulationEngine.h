@@ -3,8 +3,14 @@
 
 #include <vector>
 #include <map>
+#include <string>
 #include "ABCMethod.h"
+#include "ABCSMC.h"
+#include "Checkpoint.h"
+#include "Metrics.h"
 #include "Parameter.h"
+#include "StatsWriter.h"
+#include "StreamingStats.h"
 
 class SimulationEngine {
 public:
@@ -13,13 +19,86 @@ public:
     void addParameter(const Parameter& parameter);
     void setProductData(const SKUData& data);
     void setNormalizedFeatures(const std::map<std::string, double>& features);
-    void runSimulations(int numberOfIterations, int daysToSimulate, double tolerance);
+    void setNumberOfThreads(int threads);
+    void setNumberOfSimulations(int simulations);
+    void setSeed(unsigned long long seed);
+    void setSampler(SamplerType sampler);
+    void setDistanceMetric(DistanceMetricType type);
+    void setRegressionAdjustment(bool enabled);
+    void setSMCSettings(const SMCSettings& settings);
+    void setOutputPaths(const std::string& logPath, const std::string& statsPath);
+    void setOutputOptions(StatsFormat format, bool asyncOutput);
+
+    // Activa las métricas de etapas; al terminar runSimulations se escribe el informe en path
+    // (JSON, o Prometheus si termina en .prom). Una ruta vacía las desactiva.
+    void setMetricsPath(const std::string& path);
+
+    // Con buffered, el log y las estadísticas se escriben en memoria en lugar de en logPath y
+    // statsPath; takeBufferedOutput los entrega (y vacía) para que otro hilo los guarde
+    void setBufferedOutput(bool buffered);
+    void takeBufferedOutput(std::string& log, std::string& stats);
+
+    // Historial completo de caminos simulados: una fila por iteración con el precio de cada día
+    // (mismo formato que las estadísticas). Vacío = no se guarda; el resumen por día se calcula
+    // en línea y no necesita el historial.
+    void setPathHistoryPath(const std::string& path);
+
+    // Tiempo de carga de los datos del SKU, medido por quien los carga
+    void recordLoadTime(double seconds);
+
+    // Checkpoint del posterior del SKU (vacío = sin checkpoint). Si existe y las entradas no
+    // cambiaron, runSimulations no calibra; si cambiaron, arranca desde su posterior y
+    // ejecuta como mucho warmStartIterations iteraciones. Al terminar se reescribe.
+    void setCheckpointPath(const std::string& path);
+
+    // 0: una cuarta parte de las iteraciones de una calibración desde cero (al menos 1)
+    void setWarmStartIterations(int iterations);
+
+    // Estado calibrado tras runSimulations (o tras aplicar un checkpoint sin cambios), para
+    // responder pronósticos sin volver a calibrar
+    const std::vector<Parameter>& getParameters() const { return parameters; }
+    const SKUData& getProductData() const { return skuData; }
+    const std::map<std::string, double>& getNormalizedFeatures() const { return normalizedFeatures; }
+
+    // Resultado del último runSimulations
+    bool wasSkipped() const { return skipped; }
+    bool wasWarmStarted() const { return warmStarted; }
+
+    // Devuelve false si no se pudieron abrir los archivos de salida
+    bool runSimulations(int numberOfIterations, int daysToSimulate, double tolerance);
 
 private:
+    // Copia las probabilidades del checkpoint por nombre; true si la tabla de parámetros es la misma
+    bool applyCheckpoint(const PosteriorCheckpoint& checkpoint);
+    bool writeSkippedLog(const PosteriorCheckpoint& checkpoint);
+    std::unique_ptr<OutputSink> openOutput(const std::string& path, std::string& buffer);
+    void saveRunCheckpoint(std::uint64_t contentHash, int iterations, double tolerance, const ABCSMC& smc);
+
     std::vector<Parameter> parameters;
     ABCMethod abcMethod;
     SKUData skuData;
     std::map<std::string, double> normalizedFeatures;
+    SamplerType sampler;
+    SMCSettings smcSettings;
+    std::string logPath;
+    std::string statsPath;
+    StatsFormat statsFormat;
+    bool asyncOutput;
+    Metrics metrics;
+    std::string metricsPath;
+    std::string checkpointPath;
+    std::string pathHistoryPath;
+    bool bufferedOutput;
+    std::string logBuffer;
+    std::string statsBuffer;
+    PathStatistics pathStatistics;
+    TransitionModel iterationModel;         // modelo y camino de cada iteración, reutilizados entre iteraciones
+    std::vector<double> simulatedPrices;
+    std::vector<double> bestSimulation;
+    int warmStartIterations;
+    bool seeded;                    // false: semilla aleatoria de ABCMethod, no forma parte del checkpoint
+    bool skipped;
+    bool warmStarted;
 };
 
 #endif // SIMULATIONENGINE_H
\ No newline at end of file
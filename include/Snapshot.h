@@ -0,0 +1,116 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include "ABCMethod.h"
+#include "MappedFile.h"
+
+struct SKUJob;
+
+// Formato binario versionado con muchos SKU y sus features normalizadas en arreglos planos.
+// Todas las secciones están alineadas a 64 bytes y se leen directamente desde el mmap,
+// sin deserializar; varios hilos o procesos que abren el mismo archivo comparten las páginas.
+//
+//   SnapshotHeader
+//   SnapshotSKURecord[skuCount]         ordenados por id de SKU (búsqueda binaria)
+//   SnapshotInterval[intervalCount]
+//   SnapshotString[featureCount]        nombres de features
+//   double[skuCount * featureCount]     valores por SKU (NaN = feature ausente)
+//   char[]                              textos (ids de SKU y nombres de features)
+
+const std::uint32_t SNAPSHOT_VERSION = 1;
+const std::uint32_t SNAPSHOT_ALIGNMENT = 64;
+
+struct SnapshotHeader {
+    char magic[8];                  // "ABCSNAP\0"
+    std::uint32_t version;
+    std::uint32_t byteOrder;        // 0x01020304 en el orden nativo del escritor
+    std::uint64_t skuCount;
+    std::uint64_t intervalCount;
+    std::uint64_t featureCount;
+    std::uint64_t skuRecordsOffset;
+    std::uint64_t intervalsOffset;
+    std::uint64_t featureNamesOffset;
+    std::uint64_t featureValuesOffset;
+    std::uint64_t stringsOffset;
+    std::uint64_t stringsSize;
+    std::uint64_t fileSize;
+};
+
+struct SnapshotString {
+    std::uint64_t offset;           // relativo a stringsOffset
+    std::uint64_t length;
+};
+
+struct SnapshotSKURecord {
+    SnapshotString id;
+    std::uint64_t firstInterval;
+    std::uint64_t intervalCount;
+    double globalMinPrice;
+    double globalMaxPrice;
+};
+
+struct SnapshotInterval {
+    double minPrice;
+    double maxPrice;
+    std::int64_t count;
+};
+
+// Vista de un SKU dentro del archivo proyectado (válida mientras el SnapshotReader esté abierto)
+struct SnapshotSKUView {
+    const char* id;
+    size_t idLength;
+    const SnapshotInterval* intervals;
+    size_t intervalCount;
+    double globalMinPrice;
+    double globalMaxPrice;
+    const double* featureValues;    // featureCount valores
+
+    std::string sku() const { return std::string(id, idLength); }
+};
+
+struct SnapshotEntry {
+    SKUData skuData;
+    std::map<std::string, double> normalizedFeatures;
+};
+
+class SnapshotReader {
+public:
+    SnapshotReader();
+
+    bool open(const std::string& filename);
+
+    size_t size() const { return header == nullptr ? 0 : static_cast<size_t>(header->skuCount); }
+    size_t featureCount() const { return header == nullptr ? 0 : static_cast<size_t>(header->featureCount); }
+    std::string featureName(size_t index) const;
+
+    SnapshotSKUView view(size_t index) const;
+
+    // Búsqueda binaria por id; devuelve false si el SKU no está
+    bool find(const std::string& sku, size_t& index) const;
+
+    // Copias en las estructuras habituales para SimulationEngine
+    SKUData loadSKUData(size_t index) const;
+    std::map<std::string, double> loadNormalizedFeatures(size_t index) const;
+
+private:
+    const char* stringAt(const SnapshotString& value) const;
+
+    MappedFile file;
+    const SnapshotHeader* header;
+    const SnapshotSKURecord* records;
+    const SnapshotInterval* intervals;
+    const SnapshotString* featureNames;
+    const double* featureValues;
+    const char* strings;
+};
+
+bool writeSnapshot(const std::string& filename, std::vector<SnapshotEntry> entries);
+
+// Convierte los pares CSV/TXT de entrada en un único snapshot; devuelve el número de SKU escritos
+size_t convertToSnapshot(const std::vector<SKUJob>& jobs, const std::string& filename);
+
+#endif // SNAPSHOT_H
@@ -0,0 +1,38 @@
+#ifndef STATSWRITER_H
+#define STATSWRITER_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "OutputSink.h"
+
+enum class StatsFormat {
+    CSV,
+    Binary
+};
+
+bool parseStatsFormat(const std::string& value, StatsFormat& format);
+
+// Escritor de estadísticas por columnas. En CSV los valores se formatean con %g (igual que
+// operator<< por defecto); en binario se escribe "ABCSTAT1", el número de columnas, los
+// nombres (longitud uint32 + bytes) y luego cada fila como columnCount doubles nativos.
+class StatsWriter {
+public:
+    StatsWriter(std::unique_ptr<OutputSink> sink, StatsFormat format);
+
+    bool isOpen() const { return sink && sink->good(); }
+
+    void writeHeader(const std::vector<std::string>& columns);
+
+    // values debe tener tantos elementos como columnas
+    void writeRow(const std::vector<double>& values);
+
+    void flush();
+
+private:
+    std::unique_ptr<OutputSink> sink;
+    StatsFormat format;
+    std::string line;
+};
+
+#endif // STATSWRITER_H
@@ -0,0 +1,94 @@
+#ifndef STREAMINGSTATS_H
+#define STREAMINGSTATS_H
+
+#include <cstddef>
+#include <vector>
+
+// Acumuladores en línea para resumir caminos de precios sin guardarlos: la memoria depende
+// del número de días, no del número de iteraciones.
+
+// Media y varianza en una pasada (Welford), con mínimo y máximo. Sin valores todo vale 0.
+class RunningStats {
+public:
+    RunningStats();
+
+    void clear();
+
+    void add(double value) {
+        ++n;
+        const double delta = value - runningMean;
+        runningMean += delta / n;
+        squaredDeviations += delta * (value - runningMean);
+        minimum = n == 1 || value < minimum ? value : minimum;
+        maximum = n == 1 || value > maximum ? value : maximum;
+    }
+
+    long long count() const { return n; }
+    double mean() const { return runningMean; }
+    // Varianza muestral (n - 1)
+    double variance() const { return n > 1 ? squaredDeviations / (n - 1) : 0.0; }
+    double standardDeviation() const;
+    double min() const { return minimum; }
+    double max() const { return maximum; }
+
+private:
+    long long n;
+    double runningMean;
+    double squaredDeviations;
+    double minimum;
+    double maximum;
+};
+
+// Estimador P² de un cuantil (Jain y Chlamtac, 1985): cinco marcadores cuyas alturas se
+// ajustan con interpolación parabólica, memoria constante. Con menos de cinco valores el
+// cuantil es exacto.
+class P2Quantile {
+public:
+    explicit P2Quantile(double quantile = 0.5);
+
+    void add(double value);
+    double value() const;
+    double quantile() const { return q; }
+    long long count() const { return n; }
+
+private:
+    double parabolic(int i, double direction) const;
+    double linear(int i, int direction) const;
+
+    double q;
+    long long n;
+    double heights[5];
+    double positions[5];
+    double desired[5];
+    double increments[5];
+};
+
+// Estadísticas por día de muchos caminos de precios: media, varianza, extremos y los
+// cuantiles pedidos de cada día
+class PathStatistics {
+public:
+    PathStatistics();
+
+    // Olvida los caminos anteriores; quantiles en (0, 1)
+    void reset(int days, const std::vector<double>& quantiles);
+
+    // Acumula los primeros min(count, days) precios de un camino
+    void addPath(const double* prices, int count);
+
+    int days() const { return static_cast<int>(dayStats.size()); }
+    long long pathCount() const { return paths; }
+    const std::vector<double>& getQuantiles() const { return quantiles; }
+
+    const RunningStats& day(int d) const { return dayStats[d]; }
+
+    // Estimación del cuantil getQuantiles()[k] del día d
+    double quantile(int d, int k) const { return sketches[static_cast<size_t>(d) * quantiles.size() + k].value(); }
+
+private:
+    std::vector<double> quantiles;
+    std::vector<RunningStats> dayStats;
+    std::vector<P2Quantile> sketches;   // days × quantiles, por día
+    long long paths;
+};
+
+#endif // STREAMINGSTATS_H
@@ -0,0 +1,58 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Pool de hilos con robo de trabajo: cada hilo tiene su propia cola; toma tareas del final de
+// la suya (LIFO) y, cuando se queda sin trabajo, roba del principio de las colas de los demás.
+// Así los SKU con pocos tramos no dejan núcleos ociosos mientras otros siguen ocupados.
+class ThreadPool {
+public:
+    explicit ThreadPool(int threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Encola una tarea. Desde un hilo del pool va a su propia cola; si no, se reparte en turno rotativo.
+    void submit(std::function<void()> task);
+
+    // Bloquea hasta que todas las tareas encoladas hayan terminado
+    void wait();
+
+    int size() const { return static_cast<int>(workers.size()); }
+
+    // Número de tareas que se ejecutaron tras robarlas de otra cola
+    long long getStealCount() const { return stealCount.load(); }
+
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    void workerLoop(int index);
+    bool popLocal(int index, std::function<void()>& task);
+    bool steal(int index, std::function<void()>& task);
+
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex stateMutex;
+    std::condition_variable workAvailable;
+    std::condition_variable allDone;
+    std::atomic<long long> pendingTasks;
+    std::atomic<long long> queuedTasks;
+    std::atomic<long long> stealCount;
+    std::atomic<unsigned> nextQueue;
+    bool stopping;
+};
+
+#endif // THREADPOOL_H
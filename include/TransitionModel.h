@@ -0,0 +1,110 @@
+#ifndef TRANSITIONMODEL_H
+#define TRANSITIONMODEL_H
+
+#include <vector>
+#include <string>
+#include <map>
+#include "SKUData.h"
+#include "Parameter.h"
+#include "RandomEngine.h"
+
+// Features del SKU alineadas con una tabla de parámetros: values[k] es la feature que pondera
+// el parámetro parameterIndex[k]. Se enlaza una vez por SKU y tabla de nombres.
+struct FeatureBinding {
+    std::vector<int> parameterIndex;
+    std::vector<double> values;
+
+    void bind(const ParameterSet& parameters, const std::map<std::string, double>& normalizedFeatures);
+    int size() const { return static_cast<int>(values.size()); }
+};
+
+// Modelo de transición entre tramos de precio condicionado por las features.
+//
+// Cada parámetro calibrado pondera la feature del mismo nombre con el coeficiente
+// logit(probability), y la suma ponderada de las features da una deriva hacia tramos
+// más caros (positiva) o más baratos (negativa). Con z_j la posición del punto medio del
+// tramo j escalada a [-1, 1], la fila i de la matriz es un softmax:
+//
+//     P(i -> j) ∝ exp(drift * z_j - locality * |z_j - z_i|)
+//
+// La matriz y sus tablas alias se construyen una vez por propuesta (O(n²)); después cada
+// día cuesta un uniforme y dos lecturas, sin importar el número de tramos.
+class TransitionModel {
+public:
+    TransitionModel();
+
+    // Reutiliza la memoria de construcciones anteriores
+    void build(const SKUData& skuData,
+               const std::map<std::string, double>& normalizedFeatures,
+               const std::vector<Parameter>& parameters);
+
+    // Versión sin reservas en régimen estable: probabilities está alineado con la tabla
+    // de parámetros a la que se enlazó features
+    void build(const SKUData& skuData, const FeatureBinding& features, const double* probabilities);
+
+    int size() const { return intervalCount; }
+    bool empty() const { return intervalCount == 0; }
+    double getDrift() const { return drift; }
+
+    // Probabilidad de pasar del tramo from al tramo to (para inspección; se recalcula en O(1))
+    double probability(int from, int to) const;
+
+    // Tramo inicial según la distribución sin término de localidad
+    int sampleInitial(RandomEngine& rng) const {
+        return sampleRow(intervalCount, rng);
+    }
+
+    int sampleNext(int current, RandomEngine& rng) const {
+        return sampleRow(current, rng);
+    }
+
+    // Precio uniforme dentro del tramo
+    double samplePrice(int interval, RandomEngine& rng) const {
+        return lowers[interval] + widths[interval] * rng.uniform();
+    }
+
+    // Tablas planas para los kernels por lotes (PriceBatch): n + 1 filas de n celdas alias
+    // (la fila n es la inicial) y límite inferior y ancho de cada tramo
+    const double* getAcceptance() const { return acceptance.data(); }
+    const int* getAliases() const { return aliases.data(); }
+    const double* getLowers() const { return lowers.data(); }
+    const double* getWidths() const { return widths.data(); }
+
+private:
+    // Método alias de Walker/Vose: un uniforme elige la columna y su parte fraccionaria
+    // decide entre la columna y su alias. Las filas 0..n-1 son la matriz; la fila n es la inicial.
+    int sampleRow(int row, RandomEngine& rng) const {
+        const double u = rng.uniform() * intervalCount;
+        int column = static_cast<int>(u);
+        column = column < intervalCount ? column : intervalCount - 1;
+        const size_t slot = static_cast<size_t>(row) * intervalCount + column;
+        return u - column < acceptance[slot] ? column : aliases[slot];
+    }
+
+    double weight(int from, int to) const;
+    void buildRow(int row, const double* weights);
+
+    int intervalCount;
+    double drift;
+    std::vector<double> positions;
+    std::vector<double> lowers;
+    std::vector<double> widths;
+    std::vector<double> acceptance;
+    std::vector<int> aliases;
+    std::vector<double> rowTotals;
+
+    // Factores por tramo del peso sin normalizar de cada celda (ver weight)
+    std::vector<double> driftWeights;
+    std::vector<double> ups;
+    std::vector<double> downs;
+
+    // Memoria de trabajo de build y buildRow
+    ParameterSet parameterScratch;
+    FeatureBinding bindingScratch;
+    std::vector<double> weights;
+    std::vector<double> scaled;
+    std::vector<int> small;
+    std::vector<int> large;
+};
+
+#endif // TRANSITIONMODEL_H
@@ -0,0 +1,49 @@
+#ifndef WORKERGROUP_H
+#define WORKERGROUP_H
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Grupo de hilos persistente para repartir bloques de trabajo fijos. A diferencia de
+// ThreadPool no encola std::function: cada ronda publica un puntero a función y un contexto,
+// por lo que una vez creados los hilos run() no reserva memoria.
+class WorkerGroup {
+public:
+    WorkerGroup();
+    ~WorkerGroup();
+
+    WorkerGroup(const WorkerGroup&) = delete;
+    WorkerGroup& operator=(const WorkerGroup&) = delete;
+
+    // Ejecuta function(block) para block en [0, blocks) y espera a que terminen todos.
+    // El bloque 0 corre en el hilo llamador; los hilos que falten se crean en el primer uso.
+    template <typename Function>
+    void run(int blocks, Function& function) {
+        run(blocks, &invoke<Function>, &function);
+    }
+
+    void run(int blocks, void (*task)(void*, int), void* context);
+
+private:
+    template <typename Function>
+    static void invoke(void* function, int block) {
+        (*static_cast<Function*>(function))(block);
+    }
+
+    void workerLoop(int block, unsigned long long seenRound);
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable startRound;
+    std::condition_variable roundDone;
+    void (*task)(void*, int);
+    void* context;
+    unsigned long long round;
+    int activeBlocks;
+    int pendingBlocks;
+    bool stopping;
+};
+
+#endif // WORKERGROUP_H
@@ -1,12 +1,214 @@
 #include "../include/ABCMethod.h"
+#include "../include/AllocationCounter.h"
+#include "../include/Logger.h"
+#include "../include/PriceBatch.h"
+#include "../include/TransitionModel.h"
 #include <random>
 #include <algorithm>
 #include <cmath>
-#include <iostream>
 #include <fstream>
 #include <sstream>
+#include <limits>
+#include <thread>
 
-ABCMethod::ABCMethod() {}
+namespace {
+
+// Política preparada por prepareDistance si corresponde a skuData; si no, una local
+template <typename Metric>
+const Metric& metricFor(const Metric& prepared, bool isPrepared, Metric& local, const SKUData& skuData) {
+    if (isPrepared) {
+        return prepared;
+    }
+    local.prepare(skuData);
+    return local;
+}
+
+// Simula un camino sumando la distancia de cada día. Con una política incremental el camino
+// se abandona en cuanto la suma parcial demuestra que la distancia final superará threshold
+// y se devuelve esa cota inferior (> threshold). Con Summarize, los caminos completos dejan
+// en summary sus estadísticos de resumen respecto a reference (PATH_SUMMARY_SIZE valores);
+// los abandonados, NaN. Sin él, el bucle no calcula los momentos del camino.
+template <typename Metric, bool Summarize>
+double scoreSimulatedPath(typename Metric::Accumulator& accumulator,
+                          const TransitionModel& model,
+                          int daysToSimulate,
+                          double threshold,
+                          RandomEngine& rng,
+                          int* simulatedDays,
+                          const MomentDistance* reference,
+                          double* summary) {
+    // Las distancias diarias no son negativas, así que la suma parcial solo crece: superar
+    // threshold * días ya decide el rechazo. El margen relativo absorbe el redondeo del
+    // producto, de modo que un camino abandonado nunca habría quedado bajo threshold.
+    const double bound = threshold * daysToSimulate * (1.0 + 1e-12);
+    int day = 0;
+    accumulator.reset();
+
+    // Momentos del camino desplazados a la media de referencia
+    const double center = Summarize ? reference->getReferenceMean() : 0.0;
+    double sum = 0.0;
+    double squares = 0.0;
+
+    if (!model.empty()) {
+        int currentInterval = model.sampleInitial(rng);
+        while (day < daysToSimulate) {
+            currentInterval = model.sampleNext(currentInterval, rng);
+            const double price = model.samplePrice(currentInterval, rng);
+            accumulator.add(price);
+            if (Summarize) {
+                sum += price - center;
+                squares += (price - center) * (price - center);
+            }
+            ++day;
+            if (Metric::incremental && accumulator.partialSum() > bound) {
+                if (simulatedDays) {
+                    *simulatedDays = day;
+                }
+                if (Summarize) {
+                    std::fill(summary, summary + PATH_SUMMARY_SIZE, std::numeric_limits<double>::quiet_NaN());
+                }
+                return accumulator.partialSum() / daysToSimulate;
+            }
+        }
+    }
+
+    if (simulatedDays) {
+        *simulatedDays = day;
+    }
+    if (Summarize) {
+        const double meanOffset = day > 0 ? sum / day : 0.0;
+        const double deviation = day > 0 ? std::sqrt(std::max(0.0, squares / day - meanOffset * meanOffset)) : 0.0;
+        summary[0] = meanOffset;
+        summary[1] = deviation - reference->getReferenceDeviation();
+    }
+    return day > 0 ? accumulator.finish(day) : 0.0;
+}
+
+// Camino p de un lote SoA: un precio cada pathCount valores
+template <typename Metric>
+void scoreBatchWith(const Metric& metric, const PriceBatch& batch, std::vector<double>& distances) {
+    std::vector<double> workspace(metric.workspaceSize());
+    typename Metric::Accumulator accumulator(metric, workspace.data());
+    for (int p = 0; p < batch.pathCount; ++p) {
+        accumulator.reset();
+        for (int d = 0; d < batch.dayCount; ++d) {
+            accumulator.add(batch.day(d)[p]);
+        }
+        distances[p] = accumulator.finish(batch.dayCount);
+    }
+}
+
+template <typename Metric>
+double scoreWith(const Metric& metric,
+                 const TransitionModel& model,
+                 int daysToSimulate,
+                 double threshold,
+                 RandomEngine& rng,
+                 int* simulatedDays,
+                 const MomentDistance* reference,
+                 double* summary) {
+    std::vector<double> workspace(metric.workspaceSize());
+    typename Metric::Accumulator accumulator(metric, workspace.data());
+    if (summary) {
+        return scoreSimulatedPath<Metric, true>(accumulator, model, daysToSimulate, threshold, rng, simulatedDays,
+                                                reference, summary);
+    }
+    return scoreSimulatedPath<Metric, false>(accumulator, model, daysToSimulate, threshold, rng, simulatedDays,
+                                             nullptr, nullptr);
+}
+
+} // namespace
+
+void buildIntervalIndex(SKUData& skuData) {
+    skuData.intervalIndex.build(skuData.intervals);
+}
+
+const IntervalIndex& intervalIndexFor(const SKUData& skuData, IntervalIndex& scratch) {
+    if (skuData.intervalIndex.isBuilt() && skuData.intervalIndex.sourceCount() == skuData.intervals.size()) {
+        return skuData.intervalIndex;
+    }
+    scratch.build(skuData.intervals);
+    return scratch;
+}
+
+ABCMethod::ABCMethod()
+    : lastRefineAllocations(0),
+      lastProposals(nullptr),
+      lastDistances(nullptr),
+      lastProposalCount(0),
+      lastTolerance(0.0),
+      metrics(nullptr),
+      distanceMetric(DistanceMetricType::IntervalMiss),
+      preparedSKU(nullptr),
+      preparedIntervals(0),
+      numberOfThreads(1),
+      numberOfSimulations(1000),
+      round(0),
+      simulationCounter(0) {
+    std::random_device rd;
+    setSeed((static_cast<unsigned long long>(rd()) << 32) | rd());
+}
+
+void ABCMethod::setNumberOfThreads(int threads) {
+    this->numberOfThreads = std::max(0, threads);
+}
+
+void ABCMethod::setNumberOfSimulations(int simulations) {
+    this->numberOfSimulations = std::max(1, simulations);
+}
+
+int ABCMethod::getNumberOfThreads() const {
+    return numberOfThreads;
+}
+
+void ABCMethod::setMetrics(Metrics* metrics) {
+    this->metrics = metrics;
+}
+
+void ABCMethod::setDistanceMetric(DistanceMetricType type) {
+    this->distanceMetric = type;
+    this->preparedSKU = nullptr;
+}
+
+void ABCMethod::prepareDistance(const SKUData& skuData) {
+    // Los momentos de referencia centran también los estadísticos de resumen de cada camino
+    momentDistance.prepare(skuData);
+    switch (distanceMetric) {
+        case DistanceMetricType::Histogram:
+            histogramDistance.prepare(skuData);
+            break;
+        case DistanceMetricType::Moments:
+            break;
+        default:
+            intervalMissDistance.prepare(skuData);
+            break;
+    }
+    preparedSKU = &skuData;
+    preparedIntervals = skuData.intervals.size();
+}
+
+bool ABCMethod::isPreparedFor(const SKUData& skuData) const {
+    return preparedSKU == &skuData && preparedIntervals == skuData.intervals.size();
+}
+
+void ABCMethod::setRegressionAdjustment(bool enabled) {
+    this->summarizer.setRegressionAdjustment(enabled);
+}
+
+bool ABCMethod::getRegressionAdjustment() const {
+    return summarizer.getRegressionAdjustment();
+}
+
+void ABCMethod::setSeed(unsigned long long seed) {
+    this->seed = seed;
+    this->round = 0;
+    this->simulationCounter = 0;
+    this->masterEngine = RandomEngine(seed);
+}
+
+unsigned long long ABCMethod::getSeed() const {
+    return seed;
+}
 
 void ABCMethod::initializeParameters(std::vector<Parameter>& parameters) {
     for (auto& param : parameters) {
@@ -19,116 +221,382 @@ void ABCMethod::refineParameters(std::vector<Parameter>& parameters,
                                  const std::map<std::string, double>& normalizedFeatures,
                                  int daysToSimulate,
                                  double tolerance) {
-    std::vector<std::vector<Parameter>> acceptedParameters;
-    int numberOfSimulations = 1000;
-    
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_real_distribution<> dis(0.0, 1.0);
+    const unsigned long long allocationsBefore = AllocationCounter::threadCount();
 
-    for (int i = 0; i < numberOfSimulations; ++i) {
-        std::vector<Parameter> proposedParameters = parameters;
-        
-        for (auto& param : proposedParameters) {
-            std::normal_distribution<> d(param.probability, 0.1);
-            param.probability = std::max(0.0, std::min(1.0, d(gen)));
-        }
+    int threads = numberOfThreads;
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = std::min(threads, numberOfSimulations);
 
-        std::vector<double> simulatedPrices = simulateFuturePrices(skuData, normalizedFeatures, daysToSimulate);
-        double distance = calculateDistance(simulatedPrices, skuData);
+    // Nombres internados y probabilidades planas; las features se alinean con la tabla de nombres
+    parameterSet.assign(parameters);
+    featureBinding.bind(parameterSet, normalizedFeatures);
+    const int dimension = parameterSet.size();
 
-        if (distance < tolerance) {
-            acceptedParameters.push_back(proposedParameters);
-        }
+    // Memoria de la ronda en la arena: una fila de parámetros por propuesta, su distancia y
+    // los estadísticos de resumen de su camino. Los precios simulados no se guardan
+    // (simulateAndScore). Tras la primera ronda no se toca el heap.
+    const size_t proposalValues = static_cast<size_t>(numberOfSimulations) * dimension;
+    const size_t summaryValues = static_cast<size_t>(numberOfSimulations) * PATH_SUMMARY_SIZE;
+    proposalArena.reset();
+    proposalArena.reserve((proposalValues + numberOfSimulations + summaryValues) * sizeof(double), 3);
+    double* proposals = proposalArena.allocate<double>(proposalValues);
+    double* distances = proposalArena.allocate<double>(numberOfSimulations);
+    double* summaries = proposalArena.allocate<double>(summaryValues);
+
+    if (static_cast<int>(threadModels.size()) < threads) {
+        threadModels.resize(threads);
+        threadWorkspaces.resize(threads);
+    }
+    prepareDistance(skuData);
+    blockAllocations.assign(threads, 0);
+    if (metrics) {
+        metrics->reserveThreads(threads);
     }
 
-    if (!acceptedParameters.empty()) {  
-        for (size_t i = 0; i < parameters.size(); ++i) {
-            double sum = 0.0;
-            for (const auto& accepted : acceptedParameters) {
-                sum += accepted[i].probability;
+    // Cada hilo procesa un bloque contiguo de propuestas y escribe solo sus filas.
+    // Las semillas dependen de (ronda, propuesta), no del hilo, por lo que recorrer las filas
+    // en orden de propuesta da el mismo resultado para cualquier número de hilos.
+    unsigned long long currentRound = round++;
+
+    auto runBlock = [&](int t) {
+        const unsigned long long before = AllocationCounter::threadCount();
+        int first = static_cast<int>(static_cast<long long>(numberOfSimulations) * t / threads);
+        int last = static_cast<int>(static_cast<long long>(numberOfSimulations) * (t + 1) / threads);
+        runProposals(skuData, daysToSimulate, tolerance, first, last, currentRound, t, threadModels[t],
+                     proposals, distances, summaries);
+        blockAllocations[t] = AllocationCounter::threadCount() - before;
+    };
+    workers.run(threads, runBlock);
+
+    lastProposals = proposals;
+    lastDistances = distances;
+    lastProposalCount = numberOfSimulations;
+    lastTolerance = tolerance;
+
+    int acceptedCount = 0;
+    {
+        ABC_METRICS_SCOPE(metrics, 0, MetricStage::Accept);
+
+        // Sin ajuste por regresión, la media del resumen es la media simple de las aceptadas
+        summarizer.begin(dimension, numberOfSimulations);
+        for (int i = 0; i < numberOfSimulations; ++i) {
+            if (distances[i] <= tolerance) {
+                summarizer.add(proposals + static_cast<size_t>(i) * dimension,
+                               summaries + static_cast<size_t>(i) * PATH_SUMMARY_SIZE, distances[i], 1.0);
+                ++acceptedCount;
+            }
+        }
+        const PosteriorSummary& summary = summarizer.finish(tolerance);
+        lastSummary = summary;
+
+        if (acceptedCount > 0) {
+            double total = 0.0;
+            for (int d = 0; d < dimension; ++d) {
+                parameters[d].probability = summary.mean[d];
+                total += summary.mean[d];
             }
-            parameters[i].probability = sum / acceptedParameters.size();
+
+            // El resumen se expresa en la misma escala que las probabilidades normalizadas
+            normalizeParameters(parameters);
+            lastSummary.scale(total > 0.0 ? 1.0 / total : 1.0);
         }
-        
-        normalizeParameters(parameters);
-    } else {
-        tolerance *= 1.1;
     }
 
-    std::cout << "\n*** refineParameters ***" << std::endl;
+    LOG_DEBUG("*** refineParameters ***");
 
     for (const auto& param : parameters) {
-        std::cout << "  " << param.name << ": " << param.probability << std::endl;
+        LOG_DEBUG("  " << param.name << ": " << param.probability);
+    }
+    LOG_DEBUG("Number of accepted simulations: " << acceptedCount);
+    LOG_DEBUG("Tolerance: " << tolerance);
+
+    // El bloque 0 corre en este hilo y ya está incluido en su contador
+    lastRefineAllocations = AllocationCounter::threadCount() - allocationsBefore;
+    for (int t = 1; t < threads; ++t) {
+        lastRefineAllocations += blockAllocations[t];
     }
-    std::cout << "Number of accepted simulations: " << acceptedParameters.size() << std::endl;
-    std::cout << "Final tolerance: " << tolerance << std::endl;
 }
 
-std::vector<double> ABCMethod::simulateFuturePrices(const SKUData& skuData, 
+int ABCMethod::getLastAccepted(std::vector<double>& values, std::vector<double>& distances) const {
+    values.clear();
+    distances.clear();
+    const int dimension = parameterSet.size();
+    for (int i = 0; i < lastProposalCount; ++i) {
+        if (lastDistances[i] <= lastTolerance) {
+            const double* row = lastProposals + static_cast<size_t>(i) * dimension;
+            values.insert(values.end(), row, row + dimension);
+            distances.push_back(lastDistances[i]);
+        }
+    }
+    return static_cast<int>(distances.size());
+}
+
+void ABCMethod::runProposals(const SKUData& skuData,
+                             int daysToSimulate,
+                             double tolerance,
+                             int firstProposal,
+                             int lastProposal,
+                             unsigned long long round,
+                             int slot,
+                             TransitionModel& model,
+                             double* proposals,
+                             double* distances,
+                             double* summaries) {
+    // Una sola elección de métrica por bloque; el bucle por día queda especializado
+    switch (distanceMetric) {
+        case DistanceMetricType::Histogram:
+            runProposalsWith(histogramDistance, skuData, daysToSimulate, tolerance, firstProposal, lastProposal,
+                             round, slot, model, proposals, distances, summaries);
+            break;
+        case DistanceMetricType::Moments:
+            runProposalsWith(momentDistance, skuData, daysToSimulate, tolerance, firstProposal, lastProposal,
+                             round, slot, model, proposals, distances, summaries);
+            break;
+        default:
+            runProposalsWith(intervalMissDistance, skuData, daysToSimulate, tolerance, firstProposal, lastProposal,
+                             round, slot, model, proposals, distances, summaries);
+            break;
+    }
+}
+
+template <typename Metric>
+void ABCMethod::runProposalsWith(const Metric& metric,
+                                 const SKUData& skuData,
+                                 int daysToSimulate,
+                                 double tolerance,
+                                 int firstProposal,
+                                 int lastProposal,
+                                 unsigned long long round,
+                                 int slot,
+                                 TransitionModel& model,
+                                 double* proposals,
+                                 double* distances,
+                                 double* summaries) {
+    // La memoria de trabajo del hilo se conserva entre rondas
+    std::vector<double>& workspace = threadWorkspaces[slot];
+    if (workspace.size() < metric.workspaceSize()) {
+        workspace.resize(metric.workspaceSize());
+    }
+    typename Metric::Accumulator accumulator(metric, workspace.data());
+
+    // Flujo de la ronda (0 se reserva para simulateFuturePrices sin generador explícito)
+    RandomEngine roundEngine = masterEngine.split(round + 1);
+    std::normal_distribution<> perturbation(0.0, 0.1);
+    const int dimension = parameterSet.size();
+    const double* current = parameterSet.probabilities();
+
+    for (int i = firstProposal; i < lastProposal; ++i) {
+        // Flujo aleatorio independiente por propuesta, derivado de la semilla maestra
+        RandomEngine rng = roundEngine.split(i);
+        perturbation.reset();
+
+        double* proposed = proposals + static_cast<size_t>(i) * dimension;
+        {
+            ABC_METRICS_SCOPE(metrics, slot, MetricStage::Propose);
+            for (int d = 0; d < dimension; ++d) {
+                proposed[d] = std::max(0.0, std::min(1.0, current[d] + perturbation(rng)));
+            }
+        }
+
+        {
+            // La matriz de transición se construye una vez por propuesta
+            ABC_METRICS_SCOPE(metrics, slot, MetricStage::Simulate);
+            model.build(skuData, featureBinding, proposed);
+        }
+
+        // Simulación y distancia fusionadas: la etapa Distance incluye los días simulados
+        int simulatedDays;
+        {
+            ABC_METRICS_SCOPE(metrics, slot, MetricStage::Distance);
+            double* summary = summaries + static_cast<size_t>(i) * PATH_SUMMARY_SIZE;
+            distances[i] = scoreSimulatedPath<Metric, true>(accumulator, model, daysToSimulate, tolerance, rng,
+                                                            &simulatedDays, &momentDistance, summary);
+        }
+
+        ABC_METRICS_PROPOSAL(metrics, slot, distances[i] <= tolerance);
+        ABC_METRICS_DAYS(metrics, slot, simulatedDays, daysToSimulate - simulatedDays);
+    }
+}
+
+std::vector<double> ABCMethod::simulateFuturePrices(const std::vector<Parameter>& parameters,
+                                                    const SKUData& skuData, 
                                                     const std::map<std::string, double>& normalizedFeatures,
                                                     int daysToSimulate) {
+    RandomEngine rng = nextSimulationEngine();
+    return simulateFuturePrices(parameters, skuData, normalizedFeatures, daysToSimulate, rng);
+}
+
+std::vector<double> ABCMethod::simulateFuturePrices(const std::vector<Parameter>& parameters,
+                                                    const SKUData& skuData, 
+                                                    const std::map<std::string, double>& normalizedFeatures,
+                                                    int daysToSimulate,
+                                                    RandomEngine& rng) {
+    TransitionModel model;
+    model.build(skuData, normalizedFeatures, parameters);
+    return simulateFuturePrices(model, daysToSimulate, rng);
+}
+
+std::vector<double> ABCMethod::simulateFuturePrices(const TransitionModel& model,
+                                                    int daysToSimulate,
+                                                    RandomEngine& rng) {
     std::vector<double> futurePrices;
-    std::random_device rd;
-    std::mt19937 gen(rd());
+    if (model.empty()) {
+        return futurePrices;
+    }
+    futurePrices.resize(daysToSimulate);
+    simulatePricePath(model, daysToSimulate, rng, futurePrices.data());
+    return futurePrices;
+}
+
+RandomEngine ABCMethod::nextSimulationEngine() {
+    return masterEngine.split(0).split(simulationCounter++);
+}
+
+void ABCMethod::simulatePricePath(const TransitionModel& model,
+                                  int daysToSimulate,
+                                  RandomEngine& rng,
+                                  double* prices) {
+    if (model.empty()) {
+        return;
+    }
 
-    // Inicializar con un tramo aleatorio
-    std::uniform_int_distribution<> initialDist(0, skuData.listProducts.size() - 1);
-    int currentInterval = initialDist(gen);
+    // Inicializar con un tramo según la deriva del modelo
+    int currentInterval = model.sampleInitial(rng);
 
     for (int i = 0; i < daysToSimulate; ++i) {
-        // Calcular probabilidades de transición (puedes ajustar esto según tus necesidades)
-        std::vector<double> transitionProbs(skuData.listProducts.size(), 1.0 / skuData.listProducts.size());
-
-        // Elegir el siguiente intervalo
-        std::discrete_distribution<> transition(transitionProbs.begin(), transitionProbs.end());
-        currentInterval = transition(gen);
+        // Elegir el siguiente intervalo (tabla alias: costo constante)
+        currentInterval = model.sampleNext(currentInterval, rng);
 
         // Elegir un precio dentro del intervalo
-        std::uniform_real_distribution<> intervalDist(skuData.listProducts[currentInterval].first,
-                                                      skuData.listProducts[currentInterval].second);
-        double price = intervalDist(gen);
+        prices[i] = model.samplePrice(currentInterval, rng);
+    }
+}
 
-        futurePrices.push_back(price);
+double ABCMethod::simulateAndScore(const TransitionModel& model,
+                                   const SKUData& skuData,
+                                   int daysToSimulate,
+                                   double threshold,
+                                   RandomEngine& rng,
+                                   int* simulatedDays,
+                                   double* summary) {
+    const bool prepared = isPreparedFor(skuData);
+    MomentDistance localReference;
+    const MomentDistance* reference =
+        summary ? &metricFor(momentDistance, prepared, localReference, skuData) : nullptr;
+    switch (distanceMetric) {
+        case DistanceMetricType::Histogram: {
+            HistogramDistance local;
+            return scoreWith(metricFor(histogramDistance, prepared, local, skuData), model, daysToSimulate, threshold,
+                             rng, simulatedDays, reference, summary);
+        }
+        case DistanceMetricType::Moments: {
+            MomentDistance local;
+            return scoreWith(metricFor(momentDistance, prepared, local, skuData), model, daysToSimulate, threshold,
+                             rng, simulatedDays, reference, summary);
+        }
+        default: {
+            IntervalMissDistance local;
+            return scoreWith(metricFor(intervalMissDistance, prepared, local, skuData), model, daysToSimulate,
+                             threshold, rng, simulatedDays, reference, summary);
+        }
     }
+}
 
-    return futurePrices;
+void ABCMethod::simulatePriceBatch(const std::vector<Parameter>& parameters,
+                                   const SKUData& skuData,
+                                   const std::map<std::string, double>& normalizedFeatures,
+                                   int daysToSimulate,
+                                   int pathCount,
+                                   PriceBatch& out) {
+    TransitionModel model;
+    model.build(skuData, normalizedFeatures, parameters);
+    RandomEngine rng = nextSimulationEngine();
+    simulatePriceBatch(model, daysToSimulate, pathCount, rng, out);
+}
+
+void ABCMethod::simulatePriceBatch(const TransitionModel& model,
+                                   int daysToSimulate,
+                                   int pathCount,
+                                   const RandomEngine& rng,
+                                   PriceBatch& out) {
+    static const SimdLevel simdLevel = detectSimdLevel();
+    simulateModelPriceBatch(model, pathCount, daysToSimulate, rng, out, simdLevel);
 }
 
 double ABCMethod::calculateDistance(const std::vector<double>& simulatedPrices, const SKUData& skuData) {
-    double totalDistance = 0.0;
-    int outOfRangeCount = 0;
-
-    std::cout << "Calculating distance for " << simulatedPrices.size() << " prices" << std::endl;
-
-    for (const auto& price : simulatedPrices) {
-        auto it = std::find_if(skuData.intervals.begin(), skuData.intervals.end(),
-            [price](const PriceInterval& interval) {
-                return price >= interval.minPrice && price <= interval.maxPrice;
-            });
-
-        if (it != skuData.intervals.end()) {
-            distance += 0;
-        } else {
-            double minDist = std::numeric_limits<double>::max();
-            for (const auto& interval : skuData.intervals) {
-                double dist = std::min(std::abs(price - interval.minPrice), std::abs(price - interval.maxPrice));
-                minDist = std::min(minDist, dist);
+    return calculateDistance(simulatedPrices.data(), simulatedPrices.size(), skuData);
+}
+
+double ABCMethod::calculateDistance(const double* simulatedPrices, size_t count, const SKUData& skuData) {
+    LOG_DEBUG("Calculating " << distanceMetricName(distanceMetric) << " distance for " << count << " prices");
+
+    const bool prepared = isPreparedFor(skuData);
+    double normalizedDistance;
+    switch (distanceMetric) {
+        case DistanceMetricType::Histogram: {
+            HistogramDistance local;
+            const HistogramDistance& metric = metricFor(histogramDistance, prepared, local, skuData);
+            // La memoria de trabajo se conserva entre llamadas: el bucle de iteraciones no reserva
+            if (distanceWorkspace.size() < metric.workspaceSize()) {
+                distanceWorkspace.resize(metric.workspaceSize());
             }
-            distance += minDist;
+            normalizedDistance = metric.score(simulatedPrices, count, distanceWorkspace.data());
+            break;
+        }
+        case DistanceMetricType::Moments: {
+            MomentDistance local;
+            normalizedDistance = metricFor(momentDistance, prepared, local, skuData).score(simulatedPrices, count, nullptr);
+            break;
+        }
+        default: {
+            // Incluye la penalización de los precios fuera del rango global
+            IntervalMissDistance local;
+            normalizedDistance =
+                metricFor(intervalMissDistance, prepared, local, skuData).score(simulatedPrices, count, nullptr);
+            break;
         }
     }
 
-    // Penalizar fuertemente los precios fuera del rango global
-    totalDistance += outOfRangeCount * (skuData.globalMaxPrice - skuData.globalMinPrice);
+    LOG_DEBUG("Normalized distance: " << normalizedDistance);
+
+    return normalizedDistance;
+}
 
-    // Normalizar la distancia
-    double normalizedDistance = totalDistance / simulatedPrices.size();
+void ABCMethod::calculateBatchDistances(const PriceBatch& batch,
+                                        const SKUData& skuData,
+                                        std::vector<double>& distances) {
+    distances.assign(batch.pathCount, 0.0);
+    if (batch.dayCount == 0) {
+        return;
+    }
 
-    std::cout << "Total distance: " << totalDistance << ", Out of range count: " << outOfRangeCount << std::endl;
-    std::cout << "Normalized distance: " << normalizedDistance << std::endl;
+    const bool prepared = isPreparedFor(skuData);
+    switch (distanceMetric) {
+        case DistanceMetricType::Histogram: {
+            HistogramDistance local;
+            scoreBatchWith(metricFor(histogramDistance, prepared, local, skuData), batch, distances);
+            return;
+        }
+        case DistanceMetricType::Moments: {
+            MomentDistance local;
+            scoreBatchWith(metricFor(momentDistance, prepared, local, skuData), batch, distances);
+            return;
+        }
+        default:
+            break;
+    }
 
-    return normalizedDistance;
+    // Recorrido por días: cada día de todos los caminos es contiguo en el buffer SoA
+    IntervalMissDistance local;
+    const IntervalMissDistance& metric = metricFor(intervalMissDistance, prepared, local, skuData);
+    for (int d = 0; d < batch.dayCount; ++d) {
+        metric.accumulateDay(batch.day(d), batch.pathCount, distances.data());
+    }
+    for (auto& distance : distances) {
+        distance /= batch.dayCount;
+    }
 }
 
 void ABCMethod::normalizeParameters(std::vector<Parameter>& parameters) {
@@ -0,0 +1,369 @@
+#include "../include/ABCSMC.h"
+#include "../include/Logger.h"
+#include "../include/WorkerGroup.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <thread>
+
+namespace {
+
+// Identificador del flujo aleatorio de ABC-SMC dentro de la semilla maestra
+const std::uint64_t SMC_STREAM = 0x534D43ULL;
+
+const int MAX_PRIOR_RETRIES = 100;
+
+// Número de hilos efectivo para count elementos (0 = todos los núcleos)
+int resolveThreads(int threads, int count) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    return std::max(1, std::min(threads, count));
+}
+
+// Reparte [0, count) en threads bloques contiguos sobre el grupo de hilos persistente; cada
+// índice es independiente. function recibe el número de hilo (para las métricas y la memoria
+// de trabajo del hilo) y el índice.
+template <typename Function>
+void parallelFor(WorkerGroup& workers, int threads, int count, Function& function) {
+    auto runBlock = [threads, count, &function](int t) {
+        int first = static_cast<int>(static_cast<long long>(count) * t / threads);
+        int last = static_cast<int>(static_cast<long long>(count) * (t + 1) / threads);
+        for (int i = first; i < last; ++i) {
+            function(t, i);
+        }
+    };
+    workers.run(threads, runBlock);
+}
+
+double quantile(std::vector<double> values, double q) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    q = std::max(0.0, std::min(1.0, q));
+    size_t k = static_cast<size_t>(q * (values.size() - 1));
+    std::nth_element(values.begin(), values.begin() + k, values.end());
+    return values[k];
+}
+
+} // namespace
+
+ABCSMC::ABCSMC(ABCMethod& abcMethod, const SMCSettings& settings)
+    : abcMethod(abcMethod),
+      settings(settings),
+      skuData(nullptr),
+      daysToSimulate(0),
+      targetTolerance(0.0),
+      generation(0),
+      acceptanceRate(1.0),
+      simulationCount(0),
+      stopReason(SMCStopReason::Running) {
+    this->settings.populationSize = std::max(1, settings.populationSize);
+    this->settings.minAcceptanceRate = std::max(1e-6, std::min(1.0, settings.minAcceptanceRate));
+}
+
+void ABCSMC::prepare(const std::vector<Parameter>& parameters,
+                     const SKUData& skuData,
+                     const std::map<std::string, double>& normalizedFeatures,
+                     int daysToSimulate,
+                     double targetTolerance) {
+    this->parameterSet.assign(parameters);
+    this->featureBinding.bind(this->parameterSet, normalizedFeatures);
+    this->skuData = &skuData;
+    this->daysToSimulate = daysToSimulate;
+    this->targetTolerance = targetTolerance;
+    this->baseEngine = RandomEngine(abcMethod.getSeed()).split(SMC_STREAM);
+    this->generation = 0;
+    this->simulationCount = 0;
+    this->stopReason = SMCStopReason::Running;
+
+    population = ParticlePopulation();
+    population.dimension = static_cast<int>(parameters.size());
+
+    // La métrica se prepara aquí, antes de que los hilos de evaluateAttempts la compartan
+    abcMethod.prepareDistance(skuData);
+}
+
+void ABCSMC::initialize(const std::vector<Parameter>& parameters,
+                        const SKUData& skuData,
+                        const std::map<std::string, double>& normalizedFeatures,
+                        int daysToSimulate,
+                        double targetTolerance) {
+    prepare(parameters, skuData, normalizedFeatures, daysToSimulate, targetTolerance);
+
+    // Generación 0: todas las partículas del prior son aceptadas
+    evaluateAttempts(0, 0, settings.populationSize, std::numeric_limits<double>::infinity());
+
+    population.tolerance = 0.0;
+    for (const auto& attempt : attempts) {
+        population.values.insert(population.values.end(), attempt.values.begin(), attempt.values.end());
+        population.distances.push_back(attempt.distance);
+        population.summaries.insert(population.summaries.end(), attempt.summary, attempt.summary + PATH_SUMMARY_SIZE);
+        population.tolerance = std::max(population.tolerance, attempt.distance);
+    }
+    population.weights.assign(attempts.size(), 1.0 / attempts.size());
+    acceptanceRate = 1.0;
+    summarizePopulation();
+}
+
+void ABCSMC::initializeFrom(const ParticlePopulation& previous,
+                            const std::vector<Parameter>& parameters,
+                            const SKUData& skuData,
+                            const std::map<std::string, double>& normalizedFeatures,
+                            int daysToSimulate,
+                            double targetTolerance) {
+    if (previous.dimension != static_cast<int>(parameters.size()) || previous.size() == 0 ||
+        previous.weights.size() != static_cast<size_t>(previous.size())) {
+        LOG_WARNING("ABC-SMC: previous population does not match the parameters, starting from the prior");
+        initialize(parameters, skuData, normalizedFeatures, daysToSimulate, targetTolerance);
+        return;
+    }
+
+    prepare(parameters, skuData, normalizedFeatures, daysToSimulate, targetTolerance);
+
+    // Los datos nuevos cambian las distancias, no los pesos: la tolerancia de partida es la
+    // mayor distancia actual y las generaciones siguientes la reducen desde ahí
+    evaluateAttempts(0, 0, previous.size(), std::numeric_limits<double>::infinity(),
+                     previous.values.data());
+
+    population.values = previous.values;
+    population.weights = previous.weights;
+    population.tolerance = 0.0;
+    for (const auto& attempt : attempts) {
+        population.distances.push_back(attempt.distance);
+        population.summaries.insert(population.summaries.end(), attempt.summary, attempt.summary + PATH_SUMMARY_SIZE);
+        population.tolerance = std::max(population.tolerance, attempt.distance);
+    }
+    acceptanceRate = 1.0;
+    summarizePopulation();
+}
+
+bool ABCSMC::step() {
+    if (hasStopped() || population.size() == 0) {
+        return false;
+    }
+
+    double tolerance = std::max(targetTolerance, quantile(population.distances, settings.toleranceQuantile));
+    // La tolerancia nunca debe crecer entre generaciones
+    tolerance = std::min(tolerance, population.tolerance);
+
+    computeKernelScales();
+
+    cumulativeWeights.resize(population.weights.size());
+    double runningWeight = 0.0;
+    for (size_t i = 0; i < population.weights.size(); ++i) {
+        runningWeight += population.weights[i];
+        cumulativeWeights[i] = runningWeight;
+    }
+
+    const int populationSize = settings.populationSize;
+    const long long maxAttempts = static_cast<long long>(std::ceil(populationSize / settings.minAcceptanceRate));
+
+    ParticlePopulation next;
+    next.dimension = population.dimension;
+    next.tolerance = tolerance;
+
+    long long attemptCount = 0;
+    while (next.size() < populationSize && attemptCount < maxAttempts) {
+        int batch = static_cast<int>(std::min<long long>(populationSize, maxAttempts - attemptCount));
+        evaluateAttempts(generation + 1, attemptCount, batch, tolerance);
+
+        // Se aceptan en orden de intento: el resultado no depende del número de hilos
+        ABC_METRICS_SCOPE(abcMethod.getMetrics(), 0, MetricStage::Accept);
+        for (const auto& attempt : attempts) {
+            ++attemptCount;
+            if (attempt.accepted) {
+                next.values.insert(next.values.end(), attempt.values.begin(), attempt.values.end());
+                next.distances.push_back(attempt.distance);
+                next.summaries.insert(next.summaries.end(), attempt.summary, attempt.summary + PATH_SUMMARY_SIZE);
+                if (next.size() == populationSize) {
+                    break;
+                }
+            }
+        }
+    }
+
+    acceptanceRate = attemptCount > 0 ? static_cast<double>(next.size()) / attemptCount : 0.0;
+
+    if (next.size() < populationSize) {
+        LOG_WARNING("ABC-SMC: acceptance rate collapsed to " << acceptanceRate << " at tolerance " << tolerance
+                    << " before reaching " << targetTolerance << ", stopping without convergence");
+        stopReason = SMCStopReason::AcceptanceCollapsed;
+        return false;
+    }
+
+    // Pesos de importancia: prior uniforme / mezcla de núcleos de la generación anterior
+    next.weights.resize(populationSize);
+    double totalWeight = 0.0;
+    for (int i = 0; i < populationSize; ++i) {
+        double mixture = kernelDensityMixture(next.particle(i));
+        next.weights[i] = mixture > 0.0 ? 1.0 / mixture : 0.0;
+        totalWeight += next.weights[i];
+    }
+    for (auto& weight : next.weights) {
+        weight = totalWeight > 0.0 ? weight / totalWeight : 1.0 / populationSize;
+    }
+
+    population.values.swap(next.values);
+    population.weights.swap(next.weights);
+    population.distances.swap(next.distances);
+    population.summaries.swap(next.summaries);
+    population.tolerance = next.tolerance;
+    ++generation;
+    summarizePopulation();
+
+    if (tolerance <= targetTolerance) {
+        stopReason = SMCStopReason::Converged;
+    }
+    return true;
+}
+
+void ABCSMC::summarizePopulation() {
+    // Pesos de importancia como pesos previos; el núcleo del ajuste usa la tolerancia actual
+    PosteriorSummarizer& summarizer = abcMethod.getSummarizer();
+    summarizer.begin(population.dimension);
+    for (int i = 0; i < population.size(); ++i) {
+        summarizer.add(population.particle(i), population.summaries.data() + static_cast<size_t>(i) * PATH_SUMMARY_SIZE,
+                       population.distances[i], population.weights[i]);
+    }
+    posteriorSummary = summarizer.finish(population.tolerance);
+}
+
+void ABCSMC::writePosteriorMean(std::vector<Parameter>& parameters) const {
+    const int dimension = std::min(population.dimension, static_cast<int>(parameters.size()));
+    if (posteriorSummary.adjusted && static_cast<int>(posteriorSummary.mean.size()) >= dimension) {
+        for (int d = 0; d < dimension; ++d) {
+            parameters[d].probability = posteriorSummary.mean[d];
+        }
+        return;
+    }
+    for (int d = 0; d < dimension; ++d) {
+        double mean = 0.0;
+        for (int i = 0; i < population.size(); ++i) {
+            mean += population.weights[i] * population.particle(i)[d];
+        }
+        parameters[d].probability = mean;
+    }
+}
+
+void ABCSMC::evaluateAttempts(int targetGeneration, long long firstAttempt, int count, double tolerance,
+                              const double* fixedValues) {
+    attempts.resize(count);
+    const RandomEngine generationEngine = baseEngine.split(targetGeneration);
+    const bool fromPrior = targetGeneration == 0;
+    const int threads = resolveThreads(abcMethod.getNumberOfThreads(), count);
+    if (static_cast<int>(threadModels.size()) < threads) {
+        threadModels.resize(threads);
+    }
+    Metrics* metrics = abcMethod.getMetrics();
+    if (metrics) {
+        metrics->reserveThreads(threads);
+    }
+
+    auto evaluate = [&](int thread, int i) {
+        Attempt& attempt = attempts[i];
+        RandomEngine rng = generationEngine.split(firstAttempt + i);
+
+        {
+            ABC_METRICS_SCOPE(metrics, thread, MetricStage::Propose);
+            attempt.values.resize(population.dimension);
+            if (fixedValues) {
+                const double* source = fixedValues + static_cast<size_t>(i) * population.dimension;
+                attempt.values.assign(source, source + population.dimension);
+            } else if (fromPrior) {
+                for (auto& value : attempt.values) {
+                    value = rng.uniform();
+                }
+            } else {
+                proposeFromPopulation(rng, attempt.values);
+            }
+        }
+
+        // Los valores de la partícula están en el orden de parameterSet: son sus probabilidades
+        TransitionModel& model = threadModels[thread];
+        {
+            ABC_METRICS_SCOPE(metrics, thread, MetricStage::Simulate);
+            model.build(*skuData, featureBinding, attempt.values.data());
+        }
+
+        // Los intentos rechazados solo necesitan saber que superan la tolerancia: su distancia
+        // queda como cota inferior y no entra en la población
+        int simulatedDays;
+        {
+            ABC_METRICS_SCOPE(metrics, thread, MetricStage::Distance);
+            attempt.distance = abcMethod.simulateAndScore(model, *skuData, daysToSimulate, tolerance, rng, &simulatedDays,
+                                                          attempt.summary);
+        }
+        attempt.accepted = attempt.distance <= tolerance;
+        ABC_METRICS_PROPOSAL(metrics, thread, attempt.accepted);
+        ABC_METRICS_DAYS(metrics, thread, simulatedDays, daysToSimulate - simulatedDays);
+    };
+    parallelFor(abcMethod.getWorkers(), threads, count, evaluate);
+
+    simulationCount += count;
+}
+
+void ABCSMC::proposeFromPopulation(RandomEngine& rng, std::vector<double>& values) const {
+    std::normal_distribution<> kernel(0.0, 1.0);
+
+    for (int retry = 0; retry < MAX_PRIOR_RETRIES; ++retry) {
+        // Elegir una partícula según su peso
+        double u = rng.uniform() * cumulativeWeights.back();
+        size_t j = std::upper_bound(cumulativeWeights.begin(), cumulativeWeights.end(), u) - cumulativeWeights.begin();
+        j = std::min(j, cumulativeWeights.size() - 1);
+        const double* source = population.particle(static_cast<int>(j));
+
+        bool insidePrior = true;
+        for (int d = 0; d < population.dimension; ++d) {
+            values[d] = source[d] + kernelScales[d] * kernel(rng);
+            insidePrior = insidePrior && values[d] >= 0.0 && values[d] <= 1.0;
+        }
+        if (insidePrior) {
+            return;
+        }
+    }
+
+    for (auto& value : values) {
+        value = std::max(0.0, std::min(1.0, value));
+    }
+}
+
+void ABCSMC::computeKernelScales() {
+    const int dimension = population.dimension;
+    kernelScales.assign(dimension, 0.0);
+
+    for (int d = 0; d < dimension; ++d) {
+        double mean = 0.0;
+        for (int i = 0; i < population.size(); ++i) {
+            mean += population.weights[i] * population.particle(i)[d];
+        }
+        double variance = 0.0;
+        for (int i = 0; i < population.size(); ++i) {
+            double diff = population.particle(i)[d] - mean;
+            variance += population.weights[i] * diff * diff;
+        }
+        // Beaumont et al.: el núcleo usa el doble de la varianza ponderada
+        kernelScales[d] = std::max(1e-3, std::sqrt(2.0 * variance));
+    }
+}
+
+double ABCSMC::kernelDensityMixture(const double* values) const {
+    const double invSqrt2Pi = 0.3989422804014327;
+    double normalization = 1.0;
+    for (int d = 0; d < population.dimension; ++d) {
+        normalization *= invSqrt2Pi / kernelScales[d];
+    }
+
+    double mixture = 0.0;
+    for (int j = 0; j < population.size(); ++j) {
+        const double* source = population.particle(j);
+        double exponent = 0.0;
+        for (int d = 0; d < population.dimension; ++d) {
+            double z = (values[d] - source[d]) / kernelScales[d];
+            exponent += z * z;
+        }
+        mixture += population.weights[j] * std::exp(-0.5 * exponent);
+    }
+    return mixture * normalization;
+}
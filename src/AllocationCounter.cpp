@@ -0,0 +1,70 @@
+#include "../include/AllocationCounter.h"
+
+#if ABC_COUNT_ALLOCATIONS
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<unsigned long long> totalAllocations(0);
+thread_local unsigned long long threadAllocations = 0;
+
+void* countedAllocate(std::size_t size) {
+    ++threadAllocations;
+    totalAllocations.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+} // namespace
+
+namespace AllocationCounter {
+
+unsigned long long threadCount() {
+    return threadAllocations;
+}
+
+unsigned long long totalCount() {
+    return totalAllocations.load(std::memory_order_relaxed);
+}
+
+} // namespace AllocationCounter
+
+void* operator new(std::size_t size) {
+    void* pointer = countedAllocate(size);
+    if (!pointer) {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return countedAllocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return countedAllocate(size);
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept {
+    std::free(pointer);
+}
+
+#endif // ABC_COUNT_ALLOCATIONS
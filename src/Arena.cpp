@@ -0,0 +1,62 @@
+#include "../include/Arena.h"
+#include <algorithm>
+#include <cstdint>
+
+Arena::Arena(size_t initialBytes)
+    : cursor(nullptr), limit(nullptr), usedBytes(0), capacityBytes(0) {
+    blocks.reserve(8);
+    if (initialBytes > 0) {
+        addBlock(initialBytes);
+    }
+}
+
+void* Arena::allocateBytes(size_t bytes) {
+    bytes = std::max<size_t>(bytes, 1);
+
+    std::uintptr_t address = reinterpret_cast<std::uintptr_t>(cursor);
+    std::uintptr_t aligned = (address + ALIGNMENT - 1) & ~static_cast<std::uintptr_t>(ALIGNMENT - 1);
+    if (!cursor || aligned + bytes > reinterpret_cast<std::uintptr_t>(limit)) {
+        // Bloque nuevo del doble de la capacidad actual (o lo pedido, si es mayor)
+        addBlock(std::max(bytes, capacityBytes));
+        address = reinterpret_cast<std::uintptr_t>(cursor);
+        aligned = (address + ALIGNMENT - 1) & ~static_cast<std::uintptr_t>(ALIGNMENT - 1);
+    }
+
+    cursor = reinterpret_cast<unsigned char*>(aligned + bytes);
+    usedBytes += bytes;
+    return reinterpret_cast<void*>(aligned);
+}
+
+void Arena::addBlock(size_t bytes) {
+    // Margen para alinear el inicio del bloque
+    const size_t blockBytes = bytes + ALIGNMENT;
+    blocks.push_back(std::unique_ptr<unsigned char[]>(new unsigned char[blockBytes]));
+    cursor = blocks.back().get();
+    limit = cursor + blockBytes;
+    capacityBytes += bytes;
+}
+
+void Arena::reset() {
+    usedBytes = 0;
+    if (blocks.empty()) {
+        return;
+    }
+    if (blocks.size() > 1) {
+        const size_t total = capacityBytes;
+        blocks.clear();
+        capacityBytes = 0;
+        addBlock(total);
+        return;
+    }
+    cursor = blocks.front().get();
+    limit = cursor + capacityBytes + ALIGNMENT;
+}
+
+void Arena::reserve(size_t bytes, size_t allocations) {
+    const size_t required = bytes + allocations * ALIGNMENT;
+    if (usedBytes == 0 && capacityBytes < required) {
+        blocks.clear();
+        capacityBytes = 0;
+        addBlock(required);
+    }
+}
@@ -0,0 +1,502 @@
+#include "../include/BatchRunner.h"
+#include "../include/BoundedQueue.h"
+#include "../include/Logger.h"
+#include "../include/OutputSink.h"
+#include "../include/SimulationEngine.h"
+#include "../include/ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <dirent.h>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <thread>
+
+namespace {
+
+const std::string INTERVALS_PREFIX = "matriz_intervals_df_";
+const std::string INTERVALS_SUFFIX = ".csv";
+const std::string FEATURES_PREFIX = "df_features_";
+const std::string FEATURES_MARKER = "_sku_norm_";
+const std::string FEATURES_SUFFIX = ".txt";
+
+bool startsWith(const std::string& value, const std::string& prefix) {
+    return value.size() >= prefix.size() && value.compare(0, prefix.size(), prefix) == 0;
+}
+
+bool endsWith(const std::string& value, const std::string& suffix) {
+    return value.size() >= suffix.size() && value.compare(value.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+std::string joinPath(const std::string& directory, const std::string& name) {
+    if (directory.empty() || directory[directory.size() - 1] == '/') {
+        return directory + name;
+    }
+    return directory + "/" + name;
+}
+
+std::string trim(const std::string& value) {
+    size_t first = value.find_first_not_of(" \t\r");
+    if (first == std::string::npos) {
+        return "";
+    }
+    size_t last = value.find_last_not_of(" \t\r");
+    return value.substr(first, last - first + 1);
+}
+
+// Los mensajes de error pueden contener comas
+std::string csvField(std::string value) {
+    std::replace(value.begin(), value.end(), ',', ';');
+    return value;
+}
+
+// FNV-1a de 64 bits, para derivar la semilla de cada SKU a partir de la semilla maestra
+unsigned long long hashSKU(const std::string& sku) {
+    unsigned long long hash = 0xCBF29CE484222325ULL;
+    for (char c : sku) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+// Elementos que circulan entre las etapas de runPipelined
+struct LoadedSKU {
+    size_t index = 0;
+    std::chrono::steady_clock::time_point start;
+    double loadSeconds = 0.0;
+    SKUData skuData;
+    std::map<std::string, double> normalizedFeatures;
+    std::string error;              // no vacío: la carga falló
+};
+
+struct CalibratedSKU {
+    size_t index = 0;
+    std::chrono::steady_clock::time_point start;
+    SKUResult result;
+    std::string log;
+    std::string stats;
+};
+
+bool writeTextFile(const std::string& path, const std::string& text) {
+    FileSink file(path);
+    if (!file.good()) {
+        return false;
+    }
+    file.write(text.data(), text.size());
+    return true;
+}
+
+int resolveThreads(int threads) {
+    return threads > 0 ? threads : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+}
+
+} // namespace
+
+unsigned long long batchSeedFor(unsigned long long seed, const std::string& sku) {
+    return RandomEngine(seed).split(hashSKU(sku)).getKey();
+}
+
+std::vector<SKUJob> loadSKUManifest(const std::string& filename) {
+    std::vector<SKUJob> jobs;
+    std::ifstream file(filename);
+    std::string line;
+
+    if (!file.is_open()) {
+        LOG_ERROR("Error: Could not open file " << filename);
+        return jobs;
+    }
+
+    while (std::getline(file, line)) {
+        line = trim(line);
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        std::istringstream iss(line);
+        SKUJob job;
+        if (std::getline(iss, job.sku, ';') && std::getline(iss, job.intervalsPath, ';') &&
+            std::getline(iss, job.featuresPath)) {
+            job.sku = trim(job.sku);
+            job.intervalsPath = trim(job.intervalsPath);
+            job.featuresPath = trim(job.featuresPath);
+            jobs.push_back(job);
+        } else {
+            LOG_WARNING("Invalid manifest line: " << line);
+        }
+    }
+
+    return jobs;
+}
+
+std::vector<SKUJob> discoverSKUJobs(const std::string& directory) {
+    std::vector<SKUJob> jobs;
+    DIR* dir = opendir(directory.c_str());
+
+    if (dir == nullptr) {
+        LOG_ERROR("Error: Could not open directory " << directory);
+        return jobs;
+    }
+
+    // Clave "<SKU>_<fecha>" -> ruta, para emparejar intervalos y features del mismo día
+    std::map<std::string, std::string> intervalFiles;
+    std::map<std::string, std::string> featureFiles;
+
+    while (struct dirent* entry = readdir(dir)) {
+        std::string name = entry->d_name;
+
+        if (startsWith(name, INTERVALS_PREFIX) && endsWith(name, INTERVALS_SUFFIX)) {
+            std::string key = name.substr(INTERVALS_PREFIX.size(),
+                                          name.size() - INTERVALS_PREFIX.size() - INTERVALS_SUFFIX.size());
+            intervalFiles[key] = joinPath(directory, name);
+        } else if (startsWith(name, FEATURES_PREFIX) && endsWith(name, FEATURES_SUFFIX)) {
+            size_t marker = name.rfind(FEATURES_MARKER);
+            if (marker == std::string::npos || marker < FEATURES_PREFIX.size()) {
+                continue;
+            }
+            std::string sku = name.substr(FEATURES_PREFIX.size(), marker - FEATURES_PREFIX.size());
+            size_t dateStart = marker + FEATURES_MARKER.size();
+            std::string date = name.substr(dateStart, name.size() - dateStart - FEATURES_SUFFIX.size());
+            featureFiles[sku + "_" + date] = joinPath(directory, name);
+        }
+    }
+    closedir(dir);
+
+    for (const auto& intervals : intervalFiles) {
+        auto features = featureFiles.find(intervals.first);
+        if (features == featureFiles.end()) {
+            LOG_WARNING("Warning: no normalized features for " << intervals.second);
+            continue;
+        }
+
+        SKUJob job;
+        size_t dateSeparator = intervals.first.rfind('_');
+        job.sku = dateSeparator == std::string::npos ? intervals.first : intervals.first.substr(0, dateSeparator);
+        job.intervalsPath = intervals.second;
+        job.featuresPath = features->second;
+        jobs.push_back(job);
+    }
+
+    return jobs;
+}
+
+SKUData SKUIntervalCache::load(const SKUJob& job) {
+    auto findRow = [&job](const std::map<std::string, SKUData>& rows) {
+        auto row = rows.find(job.sku);
+        if (row == rows.end()) {
+            LOG_ERROR("Error: SKU " << job.sku << " not found in " << job.intervalsPath);
+            return SKUData();
+        }
+        return row->second;
+    };
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto file = files.find(job.intervalsPath);
+        if (file != files.end()) {
+            return findRow(file->second);
+        }
+    }
+
+    // La lectura va fuera del cerrojo para no frenar a los hilos que cargan otros archivos
+    std::vector<SKUData> rows = loadSKUDataset(job.intervalsPath);
+    if (rows.size() <= 1) {
+        return rows.empty() ? SKUData() : std::move(rows.front());
+    }
+
+    std::map<std::string, SKUData> bySKU;
+    for (auto& row : rows) {
+        std::string sku = row.sku;
+        if (!bySKU.emplace(sku, std::move(row)).second) {
+            LOG_WARNING("Duplicate SKU " << sku << " in " << job.intervalsPath << ", using its first row");
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    // Si otro hilo leyó el mismo archivo mientras tanto se conserva su copia
+    auto file = files.emplace(job.intervalsPath, std::move(bySKU)).first;
+    return findRow(file->second);
+}
+
+std::vector<SKUJob> loadSKUJobs(const std::string& path) {
+    DIR* dir = opendir(path.c_str());
+    if (dir != nullptr) {
+        closedir(dir);
+        return discoverSKUJobs(path);
+    }
+    return loadSKUManifest(path);
+}
+
+BatchRunner::BatchRunner(const SimulationConfig& config, const std::string& outputDirectory)
+    : config(config), outputDirectory(outputDirectory) {}
+
+BatchSummary BatchRunner::run(const std::vector<SKUJob>& jobs) {
+    return runAll(jobs.size(), [this, &jobs](size_t i) { return runJob(jobs[i]); });
+}
+
+BatchSummary BatchRunner::run(const SnapshotReader& snapshot) {
+    return runAll(snapshot.size(), [this, &snapshot](size_t i) { return runSnapshotJob(snapshot, i); });
+}
+
+BatchSummary BatchRunner::runPipelined(const std::vector<SKUJob>& jobs) {
+    BatchSummary summary;
+    summary.results.resize(jobs.size());
+
+    const int loaders = std::max(1, std::min(resolveThreads(config.loaderThreads), static_cast<int>(jobs.size())));
+    const int workers = std::max(1, std::min(resolveThreads(config.numberOfThreads), static_cast<int>(jobs.size())));
+    const size_t capacity = static_cast<size_t>(std::max(1, config.pipelineQueueCapacity));
+
+    BoundedQueue<LoadedSKU> loadedQueue(capacity);
+    BoundedQueue<CalibratedSKU> calibratedQueue(capacity);
+    std::atomic<size_t> nextJob(0);
+    std::atomic<int> activeLoaders(loaders);
+    std::atomic<int> activeWorkers(workers);
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> threads;
+
+    for (int i = 0; i < loaders; ++i) {
+        threads.emplace_back([&]() {
+            for (size_t index = nextJob++; index < jobs.size(); index = nextJob++) {
+                LoadedSKU loaded;
+                loaded.index = index;
+                loaded.start = std::chrono::steady_clock::now();
+                try {
+                    loaded.skuData = intervalCache.load(jobs[index]);
+                    loaded.normalizedFeatures = loadNormalizedFeatures(jobs[index].featuresPath);
+                } catch (const std::exception& e) {
+                    loaded.error = e.what();
+                }
+                loaded.loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - loaded.start).count();
+                loadedQueue.push(std::move(loaded));
+            }
+            // El último cargador en terminar avisa a los calibradores
+            if (--activeLoaders == 0) {
+                loadedQueue.close();
+            }
+        });
+    }
+
+    for (int i = 0; i < workers; ++i) {
+        threads.emplace_back([&]() {
+            LoadedSKU loaded;
+            while (loadedQueue.pop(loaded)) {
+                CalibratedSKU calibrated;
+                calibrated.index = loaded.index;
+                calibrated.start = loaded.start;
+                calibrated.result.sku = jobs[loaded.index].sku;
+                if (!loaded.error.empty()) {
+                    calibrated.result.message = loaded.error;
+                } else {
+                    try {
+                        runEngine(calibrated.result.sku, loaded.skuData, loaded.normalizedFeatures, loaded.loadSeconds,
+                                  calibrated.result, &calibrated.log, &calibrated.stats);
+                    } catch (const std::exception& e) {
+                        calibrated.result.message = e.what();
+                    }
+                }
+                calibratedQueue.push(std::move(calibrated));
+            }
+            if (--activeWorkers == 0) {
+                calibratedQueue.close();
+            }
+        });
+    }
+
+    // Escritor único: el disco recibe los archivos de un SKU cada vez
+    threads.emplace_back([&]() {
+        CalibratedSKU calibrated;
+        while (calibratedQueue.pop(calibrated)) {
+            SKUResult& result = calibrated.result;
+            const std::string& sku = result.sku;
+            if (result.succeeded) {
+                // Un SKU sin cambios solo reescribe su log; sus estadísticas siguen siendo válidas
+                bool written = writeTextFile(joinPath(outputDirectory, "simulation_log_" + sku + ".txt"), calibrated.log);
+                if (written && !result.skipped) {
+                    written = writeTextFile(joinPath(outputDirectory, "statistics_simulations_" + sku + ".txt"),
+                                            calibrated.stats);
+                }
+                if (!written) {
+                    LOG_ERROR("Error: Could not write output files for SKU " << sku);
+                    result.succeeded = false;
+                    result.skipped = false;
+                    result.message = "could not write output files";
+                }
+            }
+            result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - calibrated.start).count();
+            summary.results[calibrated.index] = std::move(result);
+        }
+    });
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    summary.seconds = std::chrono::duration<double>(end - start).count();
+
+    LOG_INFO("Pipeline: " << loaders << " loaders, " << workers << " workers, queue capacity "
+             << loadedQueue.capacity() << "; waits load " << loadedQueue.getPushWaits() << "/"
+             << loadedQueue.getPopWaits() << ", output " << calibratedQueue.getPushWaits() << "/"
+             << calibratedQueue.getPopWaits() << " (push/pop)");
+
+    finishBatchSummary(summary, outputDirectory);
+    return summary;
+}
+
+template <typename Job>
+BatchSummary BatchRunner::runAll(size_t count, Job job) {
+    BatchSummary summary;
+    summary.results.resize(count);
+
+    auto start = std::chrono::steady_clock::now();
+
+    {
+        // Paralelismo entre SKU: cada motor usa un solo hilo para no sobresuscribir los núcleos
+        ThreadPool pool(config.numberOfThreads);
+        for (size_t i = 0; i < count; ++i) {
+            pool.submit([&job, &summary, i]() {
+                summary.results[i] = job(i);
+            });
+        }
+        pool.wait();
+        summary.steals = pool.getStealCount();
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    summary.seconds = std::chrono::duration<double>(end - start).count();
+
+    finishBatchSummary(summary, outputDirectory);
+    return summary;
+}
+
+void finishBatchSummary(BatchSummary& summary, const std::string& outputDirectory) {
+    summary.succeeded = 0;
+    summary.failed = 0;
+    summary.skipped = 0;
+    for (const auto& result : summary.results) {
+        if (result.succeeded) {
+            ++summary.succeeded;
+            summary.skipped += result.skipped ? 1 : 0;
+        } else {
+            ++summary.failed;
+        }
+    }
+    summary.skusPerSecond = summary.seconds > 0.0 ? summary.results.size() / summary.seconds : 0.0;
+
+    std::ofstream summaryFile(joinPath(outputDirectory, "batch_summary.csv"));
+    if (summaryFile.is_open()) {
+        summaryFile << "SKU,Status,Seconds,Message\n";
+        for (const auto& result : summary.results) {
+            summaryFile << result.sku << "," << (!result.succeeded ? "failed" : result.skipped ? "skipped" : "ok") << ","
+                        << result.seconds << "," << csvField(result.message) << "\n";
+        }
+    } else {
+        LOG_ERROR("Error: Could not write batch summary in " << outputDirectory);
+    }
+}
+
+SKUResult BatchRunner::runJob(const SKUJob& job) const {
+    SKUResult result;
+    result.sku = job.sku;
+
+    auto start = std::chrono::steady_clock::now();
+
+    try {
+        SKUData skuData = intervalCache.load(job);
+        std::map<std::string, double> normalizedFeatures = loadNormalizedFeatures(job.featuresPath);
+        double loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        runEngine(job.sku, skuData, normalizedFeatures, loadSeconds, result);
+    } catch (const std::exception& e) {
+        result.message = e.what();
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    result.seconds = std::chrono::duration<double>(end - start).count();
+    return result;
+}
+
+SKUResult BatchRunner::runSnapshotJob(const SnapshotReader& snapshot, size_t index) const {
+    SKUResult result;
+    result.sku = snapshot.view(index).sku();
+
+    auto start = std::chrono::steady_clock::now();
+
+    try {
+        SKUData skuData = snapshot.loadSKUData(index);
+        std::map<std::string, double> normalizedFeatures = snapshot.loadNormalizedFeatures(index);
+        double loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        runEngine(result.sku, skuData, normalizedFeatures, loadSeconds, result);
+    } catch (const std::exception& e) {
+        result.message = e.what();
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    result.seconds = std::chrono::duration<double>(end - start).count();
+    return result;
+}
+
+bool BatchRunner::runEngine(const std::string& sku,
+                            const SKUData& skuData,
+                            const std::map<std::string, double>& normalizedFeatures,
+                            double loadSeconds,
+                            SKUResult& result,
+                            std::string* bufferedLog,
+                            std::string* bufferedStats) const {
+    if (skuData.listProducts.empty()) {
+        result.message = "no price intervals";
+        return false;
+    }
+
+    SimulationEngine simulationEngine;
+    simulationEngine.setProductData(skuData);
+    simulationEngine.setNormalizedFeatures(normalizedFeatures);
+    simulationEngine.setNumberOfThreads(1);
+    simulationEngine.setNumberOfSimulations(config.numberOfSimulations);
+    simulationEngine.setSampler(config.sampler);
+    simulationEngine.setDistanceMetric(config.distanceMetric);
+    simulationEngine.setRegressionAdjustment(config.regressionAdjustment);
+    simulationEngine.setSMCSettings(config.smc);
+    if (config.hasSeed) {
+        simulationEngine.setSeed(batchSeedFor(config.seed, sku));
+    }
+    simulationEngine.setOutputPaths(joinPath(outputDirectory, "simulation_log_" + sku + ".txt"),
+                                    joinPath(outputDirectory, "statistics_simulations_" + sku + ".txt"));
+    simulationEngine.setOutputOptions(config.statsFormat, config.asyncOutput);
+    simulationEngine.setBufferedOutput(bufferedLog != nullptr);
+    if (config.pathHistory) {
+        simulationEngine.setPathHistoryPath(joinPath(outputDirectory, "simulated_paths_" + sku + ".txt"));
+    }
+    if (config.metrics) {
+        // metrics_<SKU> con la extensión de metricsFile (.json por defecto)
+        std::string extension = ".json";
+        size_t dot = config.metricsFile.rfind('.');
+        if (dot != std::string::npos && config.metricsFile.find('/', dot) == std::string::npos) {
+            extension = config.metricsFile.substr(dot);
+        }
+        simulationEngine.setMetricsPath(joinPath(outputDirectory, "metrics_" + sku + extension));
+        simulationEngine.recordLoadTime(loadSeconds);
+    }
+    if (!config.checkpointDirectory.empty()) {
+        simulationEngine.setCheckpointPath(joinPath(config.checkpointDirectory, "checkpoint_" + sku + ".bin"));
+        simulationEngine.setWarmStartIterations(config.warmStartIterations);
+    }
+
+    result.succeeded = simulationEngine.runSimulations(config.numberOfIterations, config.daysToSimulate,
+                                                       config.tolerance);
+    if (bufferedLog != nullptr) {
+        std::string stats;
+        simulationEngine.takeBufferedOutput(*bufferedLog, bufferedStats != nullptr ? *bufferedStats : stats);
+    }
+    if (!result.succeeded) {
+        result.message = "could not write output files";
+    } else if (simulationEngine.wasSkipped()) {
+        result.skipped = true;
+        result.message = "unchanged since checkpoint";
+    } else if (simulationEngine.wasWarmStarted()) {
+        result.message = "warm start";
+    }
+    return result.succeeded;
+}
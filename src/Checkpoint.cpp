@@ -0,0 +1,255 @@
+#include "../include/Checkpoint.h"
+#include "../include/Logger.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+namespace {
+
+const char CHECKPOINT_MAGIC[8] = {'A', 'B', 'C', 'C', 'K', 'P', 'T', '\0'};
+const std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+const std::uint64_t FNV_OFFSET = 0xCBF29CE484222325ULL;
+const std::uint64_t FNV_PRIME = 0x100000001B3ULL;
+
+void hashBytes(std::uint64_t& hash, const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+}
+
+template <typename T>
+void hashValue(std::uint64_t& hash, T value) {
+    hashBytes(hash, &value, sizeof(value));
+}
+
+// La longitud delante del texto evita que "ab"+"c" y "a"+"bc" den el mismo hash
+void hashString(std::uint64_t& hash, const std::string& value) {
+    hashValue<std::uint64_t>(hash, value.size());
+    hashBytes(hash, value.data(), value.size());
+}
+
+template <typename T>
+void writeValue(std::ofstream& out, T value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void writeString(std::ofstream& out, const std::string& value) {
+    writeValue<std::uint64_t>(out, value.size());
+    out.write(value.data(), static_cast<std::streamsize>(value.size()));
+}
+
+void writeDoubles(std::ofstream& out, const std::vector<double>& values) {
+    if (!values.empty()) {
+        out.write(reinterpret_cast<const char*>(values.data()),
+                  static_cast<std::streamsize>(values.size() * sizeof(double)));
+    }
+}
+
+// Lector secuencial que comprueba cada longitud contra lo que queda del archivo
+class CheckpointReader {
+public:
+    CheckpointReader(std::ifstream& in, std::uint64_t size) : in(in), remaining(size) {}
+
+    template <typename T>
+    bool read(T& value) {
+        return readBytes(&value, sizeof(value));
+    }
+
+    bool readString(std::string& value) {
+        std::uint64_t length;
+        if (!read(length) || length > remaining) {
+            return false;
+        }
+        value.resize(static_cast<size_t>(length));
+        return length == 0 || readBytes(&value[0], static_cast<size_t>(length));
+    }
+
+    bool readDoubles(std::vector<double>& values, std::uint64_t count) {
+        if (count > remaining / sizeof(double)) {
+            return false;
+        }
+        values.resize(static_cast<size_t>(count));
+        return count == 0 || readBytes(values.data(), static_cast<size_t>(count) * sizeof(double));
+    }
+
+    std::uint64_t left() const { return remaining; }
+
+private:
+    bool readBytes(void* data, size_t size) {
+        if (size > remaining) {
+            return false;
+        }
+        in.read(static_cast<char*>(data), static_cast<std::streamsize>(size));
+        remaining -= size;
+        return static_cast<bool>(in);
+    }
+
+    std::ifstream& in;
+    std::uint64_t remaining;
+};
+
+bool readCheckpoint(CheckpointReader& reader, PosteriorCheckpoint& checkpoint) {
+    std::uint32_t sampler;
+    std::int32_t iterations;
+    std::uint64_t parameterCount;
+    if (!reader.read(checkpoint.contentHash) || !reader.read(sampler) || !reader.read(iterations) ||
+        !reader.read(checkpoint.tolerance) || !reader.readString(checkpoint.sku) || !reader.read(parameterCount)) {
+        return false;
+    }
+    if (sampler > static_cast<std::uint32_t>(SamplerType::SMC) || parameterCount > reader.left()) {
+        return false;
+    }
+    checkpoint.sampler = static_cast<SamplerType>(sampler);
+    checkpoint.iterations = iterations;
+
+    checkpoint.parameterNames.resize(static_cast<size_t>(parameterCount));
+    checkpoint.probabilities.resize(static_cast<size_t>(parameterCount));
+    for (size_t i = 0; i < checkpoint.parameterNames.size(); ++i) {
+        if (!reader.readString(checkpoint.parameterNames[i]) || !reader.read(checkpoint.probabilities[i])) {
+            return false;
+        }
+    }
+
+    ParticlePopulation& particles = checkpoint.particles;
+    std::int32_t dimension;
+    std::uint64_t particleCount;
+    if (!reader.read(dimension) || !reader.read(particleCount) || !reader.read(particles.tolerance)) {
+        return false;
+    }
+    if (dimension < 0 || (dimension == 0 && particleCount > 0) ||
+        (dimension > 0 && particleCount > reader.left() / sizeof(double) / dimension)) {
+        return false;
+    }
+    particles.dimension = dimension;
+    return reader.readDoubles(particles.values, particleCount * dimension) &&
+           reader.readDoubles(particles.weights, particleCount) &&
+           reader.readDoubles(particles.distances, particleCount) &&
+           reader.left() == 0;
+}
+
+} // namespace
+
+std::uint64_t hashCalibrationInputs(const SKUData& skuData,
+                                    const std::map<std::string, double>& normalizedFeatures,
+                                    const CalibrationSettings& settings) {
+    std::uint64_t hash = FNV_OFFSET;
+    hashString(hash, skuData.sku);
+    hashValue<std::uint64_t>(hash, skuData.listProducts.size());
+    for (const auto& product : skuData.listProducts) {
+        hashValue(hash, product.first);
+        hashValue(hash, product.second);
+    }
+    hashValue<std::uint64_t>(hash, skuData.intervals.size());
+    for (const auto& interval : skuData.intervals) {
+        hashValue(hash, interval.minPrice);
+        hashValue(hash, interval.maxPrice);
+        hashValue<std::int64_t>(hash, interval.count);
+    }
+    hashValue(hash, skuData.globalMinPrice);
+    hashValue(hash, skuData.globalMaxPrice);
+
+    hashValue<std::uint64_t>(hash, normalizedFeatures.size());
+    for (const auto& feature : normalizedFeatures) {
+        hashString(hash, feature.first);
+        hashValue(hash, feature.second);
+    }
+
+    hashValue<std::int32_t>(hash, settings.numberOfIterations);
+    hashValue<std::int32_t>(hash, settings.warmStartIterations);
+    hashValue<std::int32_t>(hash, settings.daysToSimulate);
+    hashValue(hash, settings.tolerance);
+    hashValue<std::int32_t>(hash, settings.numberOfSimulations);
+    hashValue<std::uint32_t>(hash, settings.hasSeed ? 1 : 0);
+    hashValue<std::uint64_t>(hash, settings.hasSeed ? settings.seed : 0);
+    hashValue<std::uint32_t>(hash, static_cast<std::uint32_t>(settings.sampler));
+    // Los ajustes de ABC-SMC solo cambian el posterior con ese muestreador
+    if (settings.sampler == SamplerType::SMC) {
+        hashValue<std::int32_t>(hash, settings.smc.populationSize);
+        hashValue(hash, settings.smc.toleranceQuantile);
+        hashValue(hash, settings.smc.minAcceptanceRate);
+    }
+    hashValue<std::uint32_t>(hash, static_cast<std::uint32_t>(settings.distanceMetric));
+    hashValue<std::uint32_t>(hash, settings.regressionAdjustment ? 1 : 0);
+    return hash;
+}
+
+bool saveCheckpoint(const std::string& path, const PosteriorCheckpoint& checkpoint) {
+    const ParticlePopulation& particles = checkpoint.particles;
+    const std::uint64_t particleCount = static_cast<std::uint64_t>(particles.size());
+    if (checkpoint.parameterNames.size() != checkpoint.probabilities.size() ||
+        particles.weights.size() != particleCount || particles.distances.size() != particleCount) {
+        LOG_ERROR("Error: inconsistent checkpoint for SKU " << checkpoint.sku);
+        return false;
+    }
+
+    const std::string temporaryPath = path + ".tmp";
+    std::ofstream out(temporaryPath, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        LOG_ERROR("Error: Could not write checkpoint " << path);
+        return false;
+    }
+
+    out.write(CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+    writeValue(out, CHECKPOINT_VERSION);
+    writeValue(out, BYTE_ORDER_MARK);
+    writeValue(out, checkpoint.contentHash);
+    writeValue<std::uint32_t>(out, static_cast<std::uint32_t>(checkpoint.sampler));
+    writeValue<std::int32_t>(out, checkpoint.iterations);
+    writeValue(out, checkpoint.tolerance);
+    writeString(out, checkpoint.sku);
+
+    writeValue<std::uint64_t>(out, checkpoint.parameterNames.size());
+    for (size_t i = 0; i < checkpoint.parameterNames.size(); ++i) {
+        writeString(out, checkpoint.parameterNames[i]);
+        writeValue(out, checkpoint.probabilities[i]);
+    }
+
+    writeValue<std::int32_t>(out, particles.dimension);
+    writeValue(out, particleCount);
+    writeValue(out, particles.tolerance);
+    writeDoubles(out, particles.values);
+    writeDoubles(out, particles.weights);
+    writeDoubles(out, particles.distances);
+
+    out.close();
+    if (!out || std::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+        LOG_ERROR("Error: Could not write checkpoint " << path);
+        std::remove(temporaryPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool loadCheckpoint(const std::string& path, PosteriorCheckpoint& checkpoint) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in.is_open()) {
+        return false;
+    }
+    const std::streamoff size = in.tellg();
+    in.seekg(0);
+
+    char magic[sizeof(CHECKPOINT_MAGIC)];
+    std::uint32_t version;
+    std::uint32_t byteOrder;
+    CheckpointReader reader(in, size > 0 ? static_cast<std::uint64_t>(size) : 0);
+    if (!reader.read(magic) || std::memcmp(magic, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC)) != 0) {
+        LOG_WARNING("Ignoring " << path << ": not a checkpoint");
+        return false;
+    }
+    if (!reader.read(version) || !reader.read(byteOrder) ||
+        version != CHECKPOINT_VERSION || byteOrder != BYTE_ORDER_MARK) {
+        LOG_WARNING("Ignoring " << path << ": unsupported checkpoint version or byte order");
+        return false;
+    }
+
+    PosteriorCheckpoint loaded;
+    if (!readCheckpoint(reader, loaded)) {
+        LOG_WARNING("Ignoring corrupted checkpoint " << path);
+        return false;
+    }
+    checkpoint = loaded;
+    return true;
+}
@@ -1,119 +1,242 @@
 #include "../include/DataLoader.h"
+#include "../include/Logger.h"
+#include "../include/FastParse.h"
+#include "../include/MappedFile.h"
 #include <fstream>
 #include <sstream>
-#include <iostream>
 #include <limits>
 #include <string>
 #include <algorithm>
 #include <stdexcept>
 
-SKUData loadSKUData(const std::string& filename) {
-    SKUData data;
-    std::ifstream file(filename);
-    std::string line;
+namespace {
 
-    if (!file.is_open()) {
-        std::cerr << "Error: Could not open file " << filename << std::endl;
-        return data;
-    }
-
-    // Leer la primera línea (encabezados)
-    std::getline(file, line);
-    std::istringstream headerStream(line);
-    std::string token;
-    std::getline(headerStream, token, ';'); // Ignorar "sku"
-    
-    // Leer los encabezados de list_products
-    while (std::getline(headerStream, token, ';')) {
-        if (token.find("list_products_") != std::string::npos) {
-            data.listProducts.push_back(std::make_pair(0.0, 0.0));
+// Quita espacios y tabuladores a ambos lados de [begin, end)
+void trimRange(const char*& begin, const char*& end) {
+    begin = skipSpaces(begin, end);
+    end = trimRight(begin, end);
+}
+
+// Lee un campo "(min, max)"
+bool parseIntervalField(const char* p, const char* end, std::pair<double, double>& interval) {
+    p = skipSpaces(p, end);
+    if (p >= end || *p != '(') {
+        return false;
+    }
+    p = skipSpaces(p + 1, end);
+    if (!parseDouble(p, end, interval.first)) {
+        return false;
+    }
+    p = skipSpaces(p, end);
+    if (p >= end || *p != ',') {
+        return false;
+    }
+    p = skipSpaces(p + 1, end);
+    if (!parseDouble(p, end, interval.second)) {
+        return false;
+    }
+    p = skipSpaces(p, end);
+    return p < end && *p == ')';
+}
+
+bool parsePriceField(const char* p, const char* end, double& value) {
+    trimRange(p, end);
+    return parseDouble(p, end, value) && p == end;
+}
+
+// Una fila de datos: sku;(min, max) × intervalColumns;min_price;max_price
+// Las celdas de tramos vacías se ignoran, así un archivo con varios SKU puede tener filas de distinto largo.
+bool parseSKURow(const char* p, const char* lineEnd, size_t intervalColumns, SKUData& data, std::string& error) {
+    const char* fieldEnd = findChar(p, lineEnd, ';');
+    const char* skuBegin = p;
+    const char* skuEnd = fieldEnd;
+    trimRange(skuBegin, skuEnd);
+    data.sku.assign(skuBegin, skuEnd);
+    p = fieldEnd < lineEnd ? fieldEnd + 1 : lineEnd;
+
+    data.listProducts.reserve(intervalColumns);
+    for (size_t column = 0; column < intervalColumns; ++column) {
+        fieldEnd = findChar(p, lineEnd, ';');
+        if (skipSpaces(p, fieldEnd) != fieldEnd) {
+            std::pair<double, double> interval;
+            if (!parseIntervalField(p, fieldEnd, interval)) {
+                error = "invalid interval in column list_products_" + std::to_string(column + 1);
+                return false;
+            }
+            data.listProducts.push_back(interval);
         }
+        p = fieldEnd < lineEnd ? fieldEnd + 1 : lineEnd;
     }
 
-    // Leer la segunda línea (datos)
-    std::getline(file, line);
-    std::istringstream dataStream(line);
-    
-    // Leer SKU
-    std::getline(dataStream, data.sku, ';');
+    fieldEnd = findChar(p, lineEnd, ';');
+    if (!parsePriceField(p, fieldEnd, data.globalMinPrice)) {
+        error = "invalid min_price";
+        return false;
+    }
+    p = fieldEnd < lineEnd ? fieldEnd + 1 : lineEnd;
 
-    // Leer intervalos de list_products
-    for (auto& interval : data.listProducts) {
-        std::string intervalStr;
-        std::getline(dataStream, intervalStr, ';');
-        sscanf(intervalStr.c_str(), "(%lf, %lf)", &interval.first, &interval.second);
+    fieldEnd = findChar(p, lineEnd, ';');
+    if (!parsePriceField(p, fieldEnd, data.globalMaxPrice)) {
+        error = "invalid max_price";
+        return false;
     }
 
-    // Leer min_price y max_price
-    std::string minPriceStr, maxPriceStr;
-    std::getline(dataStream, minPriceStr, ';');
-    std::getline(dataStream, maxPriceStr, ';');
-    data.globalMinPrice = std::stod(minPriceStr);
-    data.globalMaxPrice = std::stod(maxPriceStr);
+    // Los tramos de list_products también son los tramos observados con los que se mide la distancia
+    data.intervals.reserve(data.listProducts.size());
+    for (const auto& product : data.listProducts) {
+        PriceInterval interval = {product.first, product.second, 0};
+        data.intervals.push_back(interval);
+    }
+    buildIntervalIndex(data);
+    return true;
+}
 
-    file.close();
+// Lee hasta maxRows filas de datos (0 = todas) de un archivo de intervalos en una sola pasada
+std::vector<SKUData> loadSKURows(const std::string& filename, size_t maxRows) {
+    std::vector<SKUData> rows;
+    MappedFile file;
+
+    if (!file.open(filename)) {
+        LOG_ERROR("Error: Could not open file " << filename);
+        return rows;
+    }
+
+    LineReader reader(file.data(), file.end());
+    const char* lineBegin;
+    const char* lineEnd;
+
+    // Encabezados: contar las columnas list_products_*
+    if (!reader.next(lineBegin, lineEnd)) {
+        LOG_ERROR("Error: Empty file " << filename);
+        return rows;
+    }
+    const std::string marker = "list_products_";
+    size_t intervalColumns = 0;
+    for (const char* p = lineBegin; p < lineEnd;) {
+        const char* fieldEnd = findChar(p, lineEnd, ';');
+        if (std::search(p, fieldEnd, marker.begin(), marker.end()) != fieldEnd) {
+            ++intervalColumns;
+        }
+        p = fieldEnd < lineEnd ? fieldEnd + 1 : lineEnd;
+    }
+
+    size_t lineNumber = 1;
+    while ((maxRows == 0 || rows.size() < maxRows) && reader.next(lineBegin, lineEnd)) {
+        ++lineNumber;
+        if (lineBegin == lineEnd) {
+            continue;
+        }
+
+        SKUData data;
+        std::string error;
+        if (parseSKURow(lineBegin, lineEnd, intervalColumns, data, error)) {
+            rows.push_back(std::move(data));
+        } else {
+            LOG_ERROR("Error parsing " << filename << " line " << lineNumber << ": " << error);
+        }
+    }
+
+    return rows;
+}
+
+} // namespace
+
+SKUData loadSKUData(const std::string& filename) {
+    std::vector<SKUData> rows = loadSKURows(filename, 1);
+    if (rows.empty()) {
+        return SKUData();
+    }
+    SKUData& data = rows.front();
+
+    LOG_INFO("Loaded SKU data for " << data.sku << " with "
+             << data.listProducts.size() << " price intervals");
+    LOG_INFO("Global price range: [" << data.globalMinPrice
+             << ", " << data.globalMaxPrice << "]");
 
-    std::cout << "Loaded SKU data for " << data.sku << " with " 
-              << data.listProducts.size() << " price intervals" << std::endl;
-    std::cout << "Global price range: [" << data.globalMinPrice 
-              << ", " << data.globalMaxPrice << "]" << std::endl;
+    return std::move(data);
+}
 
-    return data;
+std::vector<SKUData> loadSKUDataset(const std::string& filename) {
+    std::vector<SKUData> rows = loadSKURows(filename, 0);
+    LOG_INFO("Loaded " << rows.size() << " SKUs from " << filename);
+    return rows;
 }
 
 std::map<std::string, double> loadNormalizedFeatures(const std::string& filename) {
     std::map<std::string, double> features;
-    std::ifstream file(filename);
-    std::string line;
+    MappedFile file;
 
-    if (!file.is_open()) {
-        std::cerr << "Error: Could not open file " << filename << std::endl;
+    if (!file.open(filename)) {
+        LOG_ERROR("Error: Could not open file " << filename);
         return features;
     }
 
-    std::cout << "\n*** loadNormalizedFeatures ***" << std::endl;
+    LOG_DEBUG("*** loadNormalizedFeatures ***");
 
-    while (std::getline(file, line)) {
-        std::istringstream iss(line);
-        std::string key, value;
+    LineReader reader(file.data(), file.end());
+    const char* lineBegin;
+    const char* lineEnd;
 
-        if (std::getline(iss, key, ':') && std::getline(iss, value)) {
-            key.erase(0, key.find_first_not_of(" \t"));
-            key.erase(key.find_last_not_of(" \t") + 1);
-            value.erase(0, value.find_first_not_of(" \t"));
-            value.erase(value.find_last_not_of(" \t") + 1);
+    // Formato: nombre: ['<id> (<valor>)']
+    while (reader.next(lineBegin, lineEnd)) {
+        const char* colon = findChar(lineBegin, lineEnd, ':');
+        if (colon == lineEnd) {
+            continue;
+        }
 
-            size_t start = value.find('(');
-            size_t end = value.find(')', start);
-            if (start != std::string::npos && end != std::string::npos) {
-                std::string featureValueStr = value.substr(start + 1, end - start - 1);
-                try {
-                    double featureValue = std::stod(featureValueStr);
-                    features[key] = featureValue;
-                    std::cout << "Loaded feature " << key << ": " << featureValue << std::endl;
-                } catch (const std::exception& e) {
-                    std::cerr << "Error parsing value for " << key << ": " << e.what() << std::endl;
-                }
-            }
+        const char* keyBegin = lineBegin;
+        const char* keyEnd = colon;
+        trimRange(keyBegin, keyEnd);
+
+        const char* open = findChar(colon + 1, lineEnd, '(');
+        const char* close = findChar(open, lineEnd, ')');
+        if (open == lineEnd || close == lineEnd) {
+            continue;
+        }
+
+        std::string key(keyBegin, keyEnd);
+        const char* valueBegin = open + 1;
+        const char* valueEnd = close;
+        trimRange(valueBegin, valueEnd);
+
+        double featureValue;
+        const char* p = valueBegin;
+        if (parseDouble(p, valueEnd, featureValue) && p == valueEnd) {
+            features[key] = featureValue;
+            LOG_DEBUG("Loaded feature " << key << ": " << featureValue);
+        } else {
+            LOG_ERROR("Error parsing value for " << key << ": " << std::string(valueBegin, valueEnd));
         }
     }
 
-    file.close();
-    std::cout << "Loaded " << features.size() << " normalized features" << std::endl;
+    LOG_INFO("Loaded " << features.size() << " normalized features");
 
     return features;
 }
 
 void loadSimulationConfig(const std::string& filename, int& numberOfIterations, double& tolerance, int& daysToSimulate) {
+    SimulationConfig config;
+    config.numberOfIterations = numberOfIterations;
+    config.tolerance = tolerance;
+    config.daysToSimulate = daysToSimulate;
+
+    loadSimulationConfig(filename, config);
+
+    numberOfIterations = config.numberOfIterations;
+    tolerance = config.tolerance;
+    daysToSimulate = config.daysToSimulate;
+}
+
+void loadSimulationConfig(const std::string& filename, SimulationConfig& config) {
     std::ifstream file(filename);
     std::string line;
 
     if (!file.is_open()) {
-        std::cerr << "Error: Could not open file " << filename << std::endl;
+        LOG_ERROR("Error: Could not open file " << filename);
         return;
     }
 
-    std::cout << "\n*** loadSimulationConfig ***" << std::endl;
+    LOG_DEBUG("*** loadSimulationConfig ***");
 
     while (std::getline(file, line)) {
         std::istringstream iss(line);
@@ -125,23 +248,118 @@ void loadSimulationConfig(const std::string& filename, int& numberOfIterations,
             value.erase(0, value.find_first_not_of(" \t"));
             value.erase(value.find_last_not_of(" \t") + 1);
 
-            std::cout << "Key: " << key << ", Value: " << value << std::endl; // Depuración
+            LOG_DEBUG("Key: " << key << ", Value: " << value); // Depuración
 
             try {
                 if (key == "numberOfIterations") {
-                    numberOfIterations = std::stoi(value);
-                    std::cout << "numberOfIterations set to " << numberOfIterations << std::endl;
+                    config.numberOfIterations = std::stoi(value);
+                    LOG_INFO("numberOfIterations set to " << config.numberOfIterations);
                 } else if (key == "tolerance") {
-                    tolerance = std::stod(value);  // Cambiado de stoi a stod
-                    std::cout << "tolerance set to " << tolerance << std::endl;
+                    config.tolerance = std::stod(value);  // Cambiado de stoi a stod
+                    LOG_INFO("tolerance set to " << config.tolerance);
                 } else if (key == "daysToSimulate") {
-                    daysToSimulate = std::stoi(value);
-                    std::cout << "daysToSimulate set to " << daysToSimulate << std::endl;
+                    config.daysToSimulate = std::stoi(value);
+                    LOG_INFO("daysToSimulate set to " << config.daysToSimulate);
+                } else if (key == "numberOfThreads") {
+                    config.numberOfThreads = std::stoi(value);
+                    LOG_INFO("numberOfThreads set to " << config.numberOfThreads);
+                } else if (key == "numberOfSimulations") {
+                    config.numberOfSimulations = std::stoi(value);
+                    LOG_INFO("numberOfSimulations set to " << config.numberOfSimulations);
+                } else if (key == "seed") {
+                    config.seed = std::stoull(value);
+                    config.hasSeed = true;
+                    LOG_INFO("seed set to " << config.seed);
+                } else if (key == "sampler") {
+                    if (value == "smc") {
+                        config.sampler = SamplerType::SMC;
+                    } else if (value == "rejection") {
+                        config.sampler = SamplerType::Rejection;
+                    } else {
+                        LOG_WARNING("Unknown sampler " << value << ", using rejection");
+                        config.sampler = SamplerType::Rejection;
+                    }
+                    LOG_INFO("sampler set to " << value);
+                } else if (key == "distanceMetric") {
+                    if (!parseDistanceMetric(value, config.distanceMetric)) {
+                        LOG_WARNING("Unknown distance metric " << value << ", using interval");
+                        config.distanceMetric = DistanceMetricType::IntervalMiss;
+                    }
+                    LOG_INFO("distanceMetric set to " << distanceMetricName(config.distanceMetric));
+                } else if (key == "regressionAdjustment") {
+                    config.regressionAdjustment = value == "true" || value == "1";
+                    LOG_INFO("regressionAdjustment set to " << (config.regressionAdjustment ? "true" : "false"));
+                } else if (key == "smcPopulationSize") {
+                    config.smc.populationSize = std::stoi(value);
+                    LOG_INFO("smcPopulationSize set to " << config.smc.populationSize);
+                } else if (key == "smcToleranceQuantile") {
+                    config.smc.toleranceQuantile = std::stod(value);
+                    LOG_INFO("smcToleranceQuantile set to " << config.smc.toleranceQuantile);
+                } else if (key == "smcMinAcceptanceRate") {
+                    config.smc.minAcceptanceRate = std::stod(value);
+                    LOG_INFO("smcMinAcceptanceRate set to " << config.smc.minAcceptanceRate);
+                } else if (key == "logLevel") {
+                    if (!parseLogLevel(value, config.logLevel)) {
+                        LOG_WARNING("Unknown log level " << value << ", using info");
+                        config.logLevel = LogLevel::Info;
+                    }
+                    // Se aplica de inmediato para que el resto del archivo ya respete el nivel
+                    Logger::setLevel(config.logLevel);
+                    LOG_INFO("logLevel set to " << value);
+                } else if (key == "logFile") {
+                    config.logFile = value;
+                    LOG_INFO("logFile set to " << config.logFile);
+                } else if (key == "outputDirectory") {
+                    config.outputDirectory = value;
+                    LOG_INFO("outputDirectory set to " << config.outputDirectory);
+                } else if (key == "statsFormat") {
+                    if (!parseStatsFormat(value, config.statsFormat)) {
+                        LOG_WARNING("Unknown stats format " << value << ", using csv");
+                        config.statsFormat = StatsFormat::CSV;
+                    }
+                    LOG_INFO("statsFormat set to " << value);
+                } else if (key == "asyncOutput") {
+                    config.asyncOutput = value == "true" || value == "1";
+                    LOG_INFO("asyncOutput set to " << (config.asyncOutput ? "true" : "false"));
+                } else if (key == "pathHistory") {
+                    config.pathHistory = value == "true" || value == "1";
+                    LOG_INFO("pathHistory set to " << (config.pathHistory ? "true" : "false"));
+                } else if (key == "metrics") {
+                    config.metrics = value == "true" || value == "1";
+                    LOG_INFO("metrics set to " << (config.metrics ? "true" : "false"));
+                } else if (key == "metricsFile") {
+                    config.metricsFile = value;
+                    config.metrics = true;
+                    LOG_INFO("metricsFile set to " << config.metricsFile);
+                } else if (key == "checkpointDirectory") {
+                    config.checkpointDirectory = value;
+                    LOG_INFO("checkpointDirectory set to " << config.checkpointDirectory);
+                } else if (key == "workerProcesses") {
+                    config.workerProcesses = std::stoi(value);
+                    LOG_INFO("workerProcesses set to " << config.workerProcesses);
+                } else if (key == "maxSKUAttempts") {
+                    config.maxSKUAttempts = std::stoi(value);
+                    LOG_INFO("maxSKUAttempts set to " << config.maxSKUAttempts);
+                } else if (key == "pipeline") {
+                    config.pipeline = value == "true" || value == "1";
+                    LOG_INFO("pipeline set to " << (config.pipeline ? "true" : "false"));
+                } else if (key == "loaderThreads") {
+                    config.loaderThreads = std::stoi(value);
+                    LOG_INFO("loaderThreads set to " << config.loaderThreads);
+                } else if (key == "pipelineQueueCapacity") {
+                    config.pipelineQueueCapacity = std::stoi(value);
+                    LOG_INFO("pipelineQueueCapacity set to " << config.pipelineQueueCapacity);
+                } else if (key == "warmStartIterations") {
+                    config.warmStartIterations = std::stoi(value);
+                    LOG_INFO("warmStartIterations set to " << config.warmStartIterations);
+                } else if (key == "queryPaths") {
+                    config.queryPaths = std::stoi(value);
+                    LOG_INFO("queryPaths set to " << config.queryPaths);
                 }
             } catch (const std::invalid_argument& e) {
-                std::cerr << "Invalid argument for key " << key << ": " << value << std::endl;
+                LOG_WARNING("Invalid argument for key " << key << ": " << value);
             } catch (const std::out_of_range& e) {
-                std::cerr << "Out of range value for key " << key << ": " << value << std::endl;
+                LOG_WARNING("Out of range value for key " << key << ": " << value);
             }
         }
     }
@@ -0,0 +1,165 @@
+#include "../include/DistanceMetric.h"
+
+namespace {
+
+double totalCount(const std::vector<PriceInterval>& intervals) {
+    double total = 0.0;
+    for (const auto& interval : intervals) {
+        total += std::max(0, interval.count);
+    }
+    return total;
+}
+
+// Peso normalizado de un tramo: su frecuencia o, si ningún tramo tiene, pesos iguales
+double intervalWeight(const PriceInterval& interval, double total, size_t intervalCount) {
+    return total > 0.0 ? std::max(0, interval.count) / total : 1.0 / intervalCount;
+}
+
+} // namespace
+
+bool parseDistanceMetric(const std::string& name, DistanceMetricType& type) {
+    if (name == "interval") {
+        type = DistanceMetricType::IntervalMiss;
+    } else if (name == "histogram") {
+        type = DistanceMetricType::Histogram;
+    } else if (name == "moments") {
+        type = DistanceMetricType::Moments;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* distanceMetricName(DistanceMetricType type) {
+    switch (type) {
+        case DistanceMetricType::Histogram:
+            return "histogram";
+        case DistanceMetricType::Moments:
+            return "moments";
+        default:
+            return "interval";
+    }
+}
+
+IntervalMissDistance::IntervalMissDistance() : index(nullptr), low(0.0), high(0.0), range(0.0) {}
+
+void IntervalMissDistance::prepare(const SKUData& skuData) {
+    index = &intervalIndexFor(skuData, localIndex);
+    low = skuData.globalMinPrice;
+    high = skuData.globalMaxPrice;
+    range = skuData.globalMaxPrice - skuData.globalMinPrice;
+}
+
+double IntervalMissDistance::score(const double* prices, size_t count, double*) const {
+    if (count == 0) {
+        return 0.0;
+    }
+
+    // La distancia a los tramos va por el bloque vectorizado del índice
+    double total = index->scoreBlock(prices, count);
+    size_t outOfRange = 0;
+    for (size_t i = 0; i < count; ++i) {
+        outOfRange += prices[i] < low || prices[i] > high ? 1 : 0;
+    }
+    total += outOfRange * range;
+    return total / count;
+}
+
+void IntervalMissDistance::accumulateDay(const double* prices, size_t count, double* totals) const {
+    index->accumulateBlock(prices, count, totals);
+    for (size_t j = 0; j < count; ++j) {
+        totals[j] += prices[j] < low || prices[j] > high ? range : 0.0;
+    }
+}
+
+HistogramDistance::HistogramDistance() : index(nullptr) {}
+
+void HistogramDistance::prepare(const SKUData& skuData) {
+    index = &intervalIndexFor(skuData, localIndex);
+
+    // Los buffers se conservan: volver a preparar el mismo SKU en cada ronda no reserva memoria
+    const double total = totalCount(skuData.intervals);
+    weightedCenters.clear();
+    for (const auto& interval : skuData.intervals) {
+        weightedCenters.push_back(std::make_pair(0.5 * (interval.minPrice + interval.maxPrice),
+                                                 intervalWeight(interval, total, skuData.intervals.size())));
+    }
+    std::sort(weightedCenters.begin(), weightedCenters.end());
+
+    centers.clear();
+    boundaries.clear();
+    referenceCDF.clear();
+    double cumulative = 0.0;
+    for (size_t k = 0; k < weightedCenters.size(); ++k) {
+        centers.push_back(weightedCenters[k].first);
+        cumulative += weightedCenters[k].second;
+        referenceCDF.push_back(cumulative);
+        if (k > 0) {
+            boundaries.push_back(0.5 * (centers[k - 1] + centers[k]));
+        }
+    }
+}
+
+double HistogramDistance::score(const double* prices, size_t count, double* workspace) const {
+    Accumulator accumulator(*this, workspace);
+    accumulator.reset();
+    for (size_t i = 0; i < count; ++i) {
+        accumulator.add(prices[i]);
+    }
+    return accumulator.finish(static_cast<int>(count));
+}
+
+double HistogramDistance::Accumulator::finish(int) const {
+    if (n == 0) {
+        return 0.0;
+    }
+
+    // W1 entre distribuciones sobre los mismos centros: área entre las dos acumuladas
+    double transport = 0.0;
+    double simulatedCDF = 0.0;
+    for (size_t k = 0; k + 1 < metric.centers.size(); ++k) {
+        simulatedCDF += counts[k];
+        transport += std::fabs(simulatedCDF / n - metric.referenceCDF[k]) * (metric.centers[k + 1] - metric.centers[k]);
+    }
+    return transport + miss / n;
+}
+
+MomentDistance::MomentDistance() : referenceMean(0.0), referenceDeviation(0.0) {}
+
+void MomentDistance::prepare(const SKUData& skuData) {
+    // Mezcla de uniformes: E[x] = Σ w (a + b) / 2, E[x²] = Σ w (a² + ab + b²) / 3
+    const double total = totalCount(skuData.intervals);
+    const size_t intervalCount = skuData.intervals.size();
+    double mean = 0.0;
+    for (const auto& interval : skuData.intervals) {
+        mean += intervalWeight(interval, total, intervalCount) * 0.5 * (interval.minPrice + interval.maxPrice);
+    }
+
+    // Segundo momento centrado en la media, por estabilidad
+    double variance = 0.0;
+    for (const auto& interval : skuData.intervals) {
+        const double a = interval.minPrice - mean;
+        const double b = interval.maxPrice - mean;
+        variance += intervalWeight(interval, total, intervalCount) * (a * a + a * b + b * b) / 3.0;
+    }
+
+    referenceMean = mean;
+    referenceDeviation = std::sqrt(std::max(0.0, variance));
+}
+
+double MomentDistance::score(const double* prices, size_t count, double* workspace) const {
+    Accumulator accumulator(*this, workspace);
+    for (size_t i = 0; i < count; ++i) {
+        accumulator.add(prices[i]);
+    }
+    return accumulator.finish(static_cast<int>(count));
+}
+
+double MomentDistance::Accumulator::finish(int) const {
+    if (n == 0) {
+        return 0.0;
+    }
+    const double meanOffset = sum / n;
+    const double deviation = std::sqrt(std::max(0.0, squares / n - meanOffset * meanOffset));
+    return std::fabs(meanOffset) + std::fabs(deviation - metric.referenceDeviation);
+}
@@ -0,0 +1,152 @@
+#include "../include/FastParse.h"
+#include <cstdlib>
+#include <cstdint>
+#include <string>
+
+namespace {
+
+// Potencias de 10 representables exactamente en double
+const double EXACT_POWERS_OF_TEN[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                      1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                      1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+const std::uint64_t MAX_EXACT_MANTISSA = static_cast<std::uint64_t>(1) << 53;
+
+inline bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+// Copia el número a un buffer terminado en '\0' y usa strtod (casos poco frecuentes)
+bool parseWithStrtod(const char* start, const char* numberEnd, const char*& p, double& value) {
+    size_t length = static_cast<size_t>(numberEnd - start);
+    if (length == 0) {
+        return false;
+    }
+
+    // Los números de más de 127 caracteres (un double grande escrito sin exponente) van al heap
+    char stackBuffer[128];
+    std::string longBuffer;
+    char* buffer = stackBuffer;
+    if (length < sizeof(stackBuffer)) {
+        std::memcpy(stackBuffer, start, length);
+        stackBuffer[length] = '\0';
+    } else {
+        longBuffer.assign(start, numberEnd);
+        buffer = &longBuffer[0];
+    }
+
+    char* parsedEnd = nullptr;
+    value = std::strtod(buffer, &parsedEnd);
+    if (parsedEnd == buffer) {
+        return false;
+    }
+    p = start + (parsedEnd - buffer);
+    return true;
+}
+
+} // namespace
+
+bool parseDouble(const char*& p, const char* end, double& value) {
+    const char* start = p;
+    const char* q = p;
+
+    bool negative = false;
+    if (q < end && (*q == '-' || *q == '+')) {
+        negative = *q == '-';
+        ++q;
+    }
+
+    std::uint64_t mantissa = 0;
+    int significantDigits = 0;
+    int exponent = 0;
+    bool anyDigit = false;
+
+    while (q < end && isDigit(*q)) {
+        anyDigit = true;
+        if (significantDigits < 19) {
+            if (mantissa != 0 || *q != '0') {
+                ++significantDigits;
+            }
+            mantissa = mantissa * 10 + static_cast<unsigned>(*q - '0');
+        } else {
+            ++exponent;
+        }
+        ++q;
+    }
+
+    if (q < end && *q == '.') {
+        ++q;
+        while (q < end && isDigit(*q)) {
+            anyDigit = true;
+            if (significantDigits < 19) {
+                if (mantissa != 0 || *q != '0') {
+                    ++significantDigits;
+                }
+                mantissa = mantissa * 10 + static_cast<unsigned>(*q - '0');
+                --exponent;
+            }
+            ++q;
+        }
+    }
+
+    if (!anyDigit) {
+        return false;
+    }
+
+    bool truncated = significantDigits >= 19;
+
+    if (q < end && (*q == 'e' || *q == 'E')) {
+        const char* exponentStart = q;
+        ++q;
+        bool exponentNegative = false;
+        if (q < end && (*q == '-' || *q == '+')) {
+            exponentNegative = *q == '-';
+            ++q;
+        }
+        if (q < end && isDigit(*q)) {
+            int explicitExponent = 0;
+            while (q < end && isDigit(*q)) {
+                if (explicitExponent < 10000) {
+                    explicitExponent = explicitExponent * 10 + (*q - '0');
+                }
+                ++q;
+            }
+            exponent += exponentNegative ? -explicitExponent : explicitExponent;
+        } else {
+            // "1e" no lleva exponente: el número termina antes de la 'e'
+            q = exponentStart;
+        }
+    }
+
+    // Camino rápido de Clinger: mantisa y potencia de 10 exactas dan un resultado correctamente redondeado
+    if (!truncated && mantissa <= MAX_EXACT_MANTISSA && exponent >= -22 && exponent <= 22) {
+        double result = static_cast<double>(mantissa);
+        result = exponent < 0 ? result / EXACT_POWERS_OF_TEN[-exponent] : result * EXACT_POWERS_OF_TEN[exponent];
+        value = negative ? -result : result;
+        p = q;
+        return true;
+    }
+
+    return parseWithStrtod(start, q, p, value);
+}
+
+bool parseInt(const char*& p, const char* end, long long& value) {
+    const char* q = p;
+    bool negative = false;
+    if (q < end && (*q == '-' || *q == '+')) {
+        negative = *q == '-';
+        ++q;
+    }
+    if (q >= end || !isDigit(*q)) {
+        return false;
+    }
+
+    long long result = 0;
+    while (q < end && isDigit(*q)) {
+        result = result * 10 + (*q - '0');
+        ++q;
+    }
+    value = negative ? -result : result;
+    p = q;
+    return true;
+}
@@ -0,0 +1,59 @@
+#include "../include/IntervalIndex.h"
+#include <algorithm>
+#include <limits>
+
+IntervalIndex::IntervalIndex() : sourceIntervals(0) {}
+
+IntervalIndex::IntervalIndex(const std::vector<PriceInterval>& intervals) {
+    build(intervals);
+}
+
+void IntervalIndex::build(const std::vector<PriceInterval>& intervals) {
+    const double inf = std::numeric_limits<double>::infinity();
+
+    std::vector<std::pair<double, double>> sorted;
+    sorted.reserve(intervals.size());
+    for (const auto& interval : intervals) {
+        sorted.push_back(std::make_pair(std::min(interval.minPrice, interval.maxPrice),
+                                        std::max(interval.minPrice, interval.maxPrice)));
+    }
+    std::sort(sorted.begin(), sorted.end());
+
+    lowers.clear();
+    uppers.clear();
+    lowers.reserve(sorted.size() + 2);
+    uppers.reserve(sorted.size() + 2);
+
+    // Centinela inferior
+    lowers.push_back(-inf);
+    uppers.push_back(-inf);
+
+    for (const auto& interval : sorted) {
+        if (lowers.size() > 1 && interval.first <= uppers.back()) {
+            uppers.back() = std::max(uppers.back(), interval.second);
+        } else {
+            lowers.push_back(interval.first);
+            uppers.push_back(interval.second);
+        }
+    }
+
+    // Centinela superior: garantiza que la búsqueda siempre encuentre un tramo
+    lowers.push_back(inf);
+    uppers.push_back(inf);
+
+    sourceIntervals = intervals.size();
+}
+
+double IntervalIndex::scoreBlock(const double* prices, size_t count, size_t stride) const {
+    double total = 0.0;
+    for (size_t i = 0; i < count; ++i) {
+        total += distance(prices[i * stride]);
+    }
+    return total;
+}
+
+void IntervalIndex::accumulateBlock(const double* prices, size_t count, double* totals) const {
+    for (size_t i = 0; i < count; ++i) {
+        totals[i] += distance(prices[i]);
+    }
+}
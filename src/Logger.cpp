@@ -0,0 +1,83 @@
+#include "../include/Logger.h"
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+
+namespace {
+
+std::atomic<int> level(static_cast<int>(LogLevel::Info));
+std::mutex sinkMutex;
+std::unique_ptr<OutputSink> customSink;
+ConsoleSink standardError(stderr);
+ConsoleSink console(stdout);
+
+} // namespace
+
+void Logger::setLevel(LogLevel newLevel) {
+    level.store(static_cast<int>(newLevel), std::memory_order_relaxed);
+}
+
+LogLevel Logger::getLevel() {
+    return static_cast<LogLevel>(level.load(std::memory_order_relaxed));
+}
+
+int Logger::currentLevel() {
+    return level.load(std::memory_order_relaxed);
+}
+
+void Logger::setSink(std::unique_ptr<OutputSink> sink) {
+    std::lock_guard<std::mutex> lock(sinkMutex);
+    if (customSink) {
+        customSink->flush();
+    }
+    customSink = std::move(sink);
+}
+
+void Logger::setConsole(FILE* stream) {
+    std::lock_guard<std::mutex> lock(sinkMutex);
+    console.flush();
+    console = ConsoleSink(stream);
+}
+
+void Logger::write(LogLevel messageLevel, const std::string& message) {
+    std::lock_guard<std::mutex> lock(sinkMutex);
+
+    if (messageLevel >= LogLevel::Warning) {
+        standardError.write(message.data(), message.size());
+        standardError.write("\n", 1);
+        if (customSink) {
+            customSink->write(message.data(), message.size());
+            customSink->write("\n", 1);
+        }
+        return;
+    }
+
+    OutputSink& sink = customSink ? *customSink : console;
+    sink.write(message.data(), message.size());
+    sink.write("\n", 1);
+}
+
+void Logger::flush() {
+    std::lock_guard<std::mutex> lock(sinkMutex);
+    if (customSink) {
+        customSink->flush();
+    }
+    console.flush();
+}
+
+bool parseLogLevel(const std::string& value, LogLevel& result) {
+    if (value == "debug") {
+        result = LogLevel::Debug;
+    } else if (value == "info") {
+        result = LogLevel::Info;
+    } else if (value == "warning") {
+        result = LogLevel::Warning;
+    } else if (value == "error") {
+        result = LogLevel::Error;
+    } else if (value == "off") {
+        result = LogLevel::Off;
+    } else {
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,77 @@
+#include "../include/MappedFile.h"
+#include <fstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile() : begin(nullptr), length(0), opened(false), mapping(nullptr) {}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string& filename) {
+    close();
+
+#ifndef _WIN32
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    length = static_cast<size_t>(info.st_size);
+    if (length > 0) {
+        void* address = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (address == MAP_FAILED) {
+            ::close(fd);
+            length = 0;
+            return false;
+        }
+        // Lectura secuencial: el kernel puede adelantar páginas
+        madvise(address, length, MADV_SEQUENTIAL);
+        mapping = address;
+        begin = static_cast<const char*>(address);
+    }
+    ::close(fd);
+#else
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return false;
+    }
+    length = static_cast<size_t>(file.tellg());
+    buffer.resize(length);
+    file.seekg(0);
+    if (length > 0 && !file.read(buffer.data(), length)) {
+        buffer.clear();
+        length = 0;
+        return false;
+    }
+    begin = buffer.data();
+#endif
+
+    opened = true;
+    return true;
+}
+
+void MappedFile::close() {
+#ifndef _WIN32
+    if (mapping != nullptr) {
+        munmap(mapping, length);
+        mapping = nullptr;
+    }
+#endif
+    buffer.clear();
+    begin = nullptr;
+    length = 0;
+    opened = false;
+}
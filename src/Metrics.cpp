@@ -0,0 +1,230 @@
+#include "../include/Metrics.h"
+#include "../include/OutputSink.h"
+#include <cstdint>
+#include <cstring>
+#include <new>
+
+namespace {
+
+const int STAGE_COUNT = static_cast<int>(MetricStage::Count);
+
+bool endsWith(const std::string& value, const std::string& suffix) {
+    return value.size() >= suffix.size() && value.compare(value.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// Escapa comillas y barras para las cadenas del JSON y de las etiquetas de Prometheus
+std::string escape(const std::string& value) {
+    std::string escaped;
+    for (char c : value) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+void writeStagesJson(std::ostream& out, const ThreadMetrics& metrics, const char* indent) {
+    out << "{\n";
+    for (int s = 0; s < STAGE_COUNT; ++s) {
+        out << indent << "  \"" << metricStageName(static_cast<MetricStage>(s)) << "\": {\"seconds\": "
+            << metrics.stageNanos[s] * 1e-9 << ", \"calls\": " << metrics.stageCalls[s] << "}"
+            << (s + 1 < STAGE_COUNT ? ",\n" : "\n");
+    }
+    out << indent << "}";
+}
+
+void writeJson(std::ostream& out, const Metrics& metrics, const std::string& sku, const std::string& sampler,
+               double wallSeconds) {
+    const ThreadMetrics totals = metrics.totals();
+
+    out << "{\n";
+    out << "  \"sku\": \"" << escape(sku) << "\",\n";
+    out << "  \"sampler\": \"" << sampler << "\",\n";
+    out << "  \"wallSeconds\": " << wallSeconds << ",\n";
+    out << "  \"proposals\": " << totals.proposals << ",\n";
+    out << "  \"simulations\": " << totals.simulations << ",\n";
+    out << "  \"accepted\": " << totals.accepted << ",\n";
+    out << "  \"simulatedDays\": " << totals.simulatedDays << ",\n";
+    out << "  \"skippedDays\": " << totals.skippedDays << ",\n";
+    out << "  \"simulationsPerSecond\": " << (wallSeconds > 0.0 ? totals.simulations / wallSeconds : 0.0) << ",\n";
+    out << "  \"stages\": ";
+    writeStagesJson(out, totals, "  ");
+    out << ",\n";
+
+    out << "  \"threads\": [\n";
+    for (int t = 0; t < metrics.threadCount(); ++t) {
+        const ThreadMetrics& thread = metrics.thread(t);
+        out << "    {\"thread\": " << t << ", \"proposals\": " << thread.proposals
+            << ", \"simulations\": " << thread.simulations << ", \"accepted\": " << thread.accepted
+            << ", \"stages\": ";
+        writeStagesJson(out, thread, "    ");
+        out << "}" << (t + 1 < metrics.threadCount() ? ",\n" : "\n");
+    }
+    out << "  ],\n";
+
+    out << "  \"iterations\": [\n";
+    const std::vector<IterationMetrics>& iterations = metrics.getIterations();
+    for (size_t i = 0; i < iterations.size(); ++i) {
+        const IterationMetrics& iteration = iterations[i];
+        out << "    {\"iteration\": " << iteration.iteration << ", \"proposals\": " << iteration.proposals
+            << ", \"accepted\": " << iteration.accepted << ", \"acceptanceRate\": " << iteration.acceptanceRate
+            << ", \"seconds\": " << iteration.seconds << "}" << (i + 1 < iterations.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n";
+    out << "}\n";
+}
+
+void writePrometheus(std::ostream& out, const Metrics& metrics, const std::string& sku, const std::string& sampler,
+                     double wallSeconds) {
+    const std::string labels = "sku=\"" + escape(sku) + "\",sampler=\"" + sampler + "\"";
+    const ThreadMetrics totals = metrics.totals();
+
+    out << "# TYPE abc_wall_seconds gauge\n";
+    out << "abc_wall_seconds{" << labels << "} " << wallSeconds << '\n';
+    out << "# TYPE abc_simulations_per_second gauge\n";
+    out << "abc_simulations_per_second{" << labels << "} "
+        << (wallSeconds > 0.0 ? totals.simulations / wallSeconds : 0.0) << '\n';
+
+    // Cada familia de métricas va contigua tras su línea TYPE, como exige el formato
+    out << "# TYPE abc_proposals_total counter\n";
+    for (int t = 0; t < metrics.threadCount(); ++t) {
+        out << "abc_proposals_total{" << labels << ",thread=\"" << t << "\"} " << metrics.thread(t).proposals << '\n';
+    }
+    out << "# TYPE abc_accepted_total counter\n";
+    for (int t = 0; t < metrics.threadCount(); ++t) {
+        out << "abc_accepted_total{" << labels << ",thread=\"" << t << "\"} " << metrics.thread(t).accepted << '\n';
+    }
+    out << "# TYPE abc_simulated_days_total counter\n";
+    for (int t = 0; t < metrics.threadCount(); ++t) {
+        out << "abc_simulated_days_total{" << labels << ",thread=\"" << t << "\"} " << metrics.thread(t).simulatedDays << '\n';
+    }
+    out << "# TYPE abc_skipped_days_total counter\n";
+    for (int t = 0; t < metrics.threadCount(); ++t) {
+        out << "abc_skipped_days_total{" << labels << ",thread=\"" << t << "\"} " << metrics.thread(t).skippedDays << '\n';
+    }
+    out << "# TYPE abc_stage_seconds_total counter\n";
+    for (int t = 0; t < metrics.threadCount(); ++t) {
+        for (int s = 0; s < STAGE_COUNT; ++s) {
+            out << "abc_stage_seconds_total{" << labels << ",thread=\"" << t << "\",stage=\""
+                << metricStageName(static_cast<MetricStage>(s)) << "\"} " << metrics.thread(t).stageNanos[s] * 1e-9 << '\n';
+        }
+    }
+    out << "# TYPE abc_stage_calls_total counter\n";
+    for (int t = 0; t < metrics.threadCount(); ++t) {
+        for (int s = 0; s < STAGE_COUNT; ++s) {
+            out << "abc_stage_calls_total{" << labels << ",thread=\"" << t << "\",stage=\""
+                << metricStageName(static_cast<MetricStage>(s)) << "\"} " << metrics.thread(t).stageCalls[s] << '\n';
+        }
+    }
+
+    out << "# TYPE abc_iteration_acceptance_rate gauge\n";
+    for (const auto& iteration : metrics.getIterations()) {
+        out << "abc_iteration_acceptance_rate{" << labels << ",iteration=\"" << iteration.iteration << "\"} "
+            << iteration.acceptanceRate << '\n';
+    }
+}
+
+} // namespace
+
+const char* metricStageName(MetricStage stage) {
+    switch (stage) {
+        case MetricStage::Load:
+            return "load";
+        case MetricStage::Propose:
+            return "propose";
+        case MetricStage::Simulate:
+            return "simulate";
+        case MetricStage::Distance:
+            return "distance";
+        case MetricStage::Accept:
+            return "accept";
+        default:
+            return "unknown";
+    }
+}
+
+ThreadMetrics::ThreadMetrics() : proposals(0), simulations(0), accepted(0), simulatedDays(0), skippedDays(0) {
+    std::memset(stageNanos, 0, sizeof(stageNanos));
+    std::memset(stageCalls, 0, sizeof(stageCalls));
+}
+
+Metrics::Metrics() : enabled(false), threads(nullptr), threadSlots(0), iterationProposals(0), iterationAccepted(0) {
+    reserveThreads(1);
+}
+
+void Metrics::setEnabled(bool enabled) {
+    this->enabled = enabled;
+}
+
+void Metrics::reserveThreads(int count) {
+    if (threadSlots >= count) {
+        return;
+    }
+
+    const size_t alignment = alignof(ThreadMetrics);
+    std::unique_ptr<unsigned char[]> storage(new unsigned char[count * sizeof(ThreadMetrics) + alignment]);
+    const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(storage.get());
+    ThreadMetrics* slots = reinterpret_cast<ThreadMetrics*>((address + alignment - 1) &
+                                                            ~static_cast<std::uintptr_t>(alignment - 1));
+    // Los hilos ya registrados conservan lo acumulado
+    for (int t = 0; t < count; ++t) {
+        new (slots + t) ThreadMetrics(t < threadSlots ? threads[t] : ThreadMetrics());
+    }
+
+    threadStorage = std::move(storage);
+    threads = slots;
+    threadSlots = count;
+}
+
+void Metrics::endIteration(int iteration, double seconds, double acceptanceRate) {
+    if (!enabled) {
+        return;
+    }
+    const ThreadMetrics current = totals();
+
+    IterationMetrics record;
+    record.iteration = iteration;
+    record.proposals = current.proposals - iterationProposals;
+    record.accepted = current.accepted - iterationAccepted;
+    record.acceptanceRate = acceptanceRate >= 0.0
+                                ? acceptanceRate
+                                : (record.proposals > 0 ? static_cast<double>(record.accepted) / record.proposals : 0.0);
+    record.seconds = seconds;
+    iterations.push_back(record);
+
+    iterationProposals = current.proposals;
+    iterationAccepted = current.accepted;
+}
+
+ThreadMetrics Metrics::totals() const {
+    ThreadMetrics sum;
+    for (int t = 0; t < threadSlots; ++t) {
+        const ThreadMetrics& thread = threads[t];
+        for (int s = 0; s < STAGE_COUNT; ++s) {
+            sum.stageNanos[s] += thread.stageNanos[s];
+            sum.stageCalls[s] += thread.stageCalls[s];
+        }
+        sum.proposals += thread.proposals;
+        sum.simulations += thread.simulations;
+        sum.accepted += thread.accepted;
+        sum.simulatedDays += thread.simulatedDays;
+        sum.skippedDays += thread.skippedDays;
+    }
+    return sum;
+}
+
+bool Metrics::writeReport(const std::string& path, const std::string& sku, const std::string& sampler,
+                          double wallSeconds) const {
+    SinkStream out(openFileSink(path, false));
+    if (!out.isOpen()) {
+        return false;
+    }
+    if (endsWith(path, ".prom")) {
+        writePrometheus(out, *this, sku, sampler, wallSeconds);
+    } else {
+        writeJson(out, *this, sku, sampler, wallSeconds);
+    }
+    out.close();
+    return true;
+}
@@ -0,0 +1,145 @@
+#include "../include/OutputSink.h"
+
+FileSink::FileSink(const std::string& path, size_t bufferSize) : buffer(bufferSize) {
+    file = std::fopen(path.c_str(), "wb");
+    if (file != nullptr && bufferSize > 0) {
+        std::setvbuf(file, buffer.data(), _IOFBF, buffer.size());
+    }
+}
+
+FileSink::~FileSink() {
+    if (file != nullptr) {
+        std::fclose(file);
+    }
+}
+
+void FileSink::write(const char* data, size_t size) {
+    if (file != nullptr) {
+        std::fwrite(data, 1, size, file);
+    }
+}
+
+void FileSink::flush() {
+    if (file != nullptr) {
+        std::fflush(file);
+    }
+}
+
+AsyncSink::AsyncSink(std::unique_ptr<OutputSink> target, size_t maxPending)
+    : target(std::move(target)), maxPending(maxPending), writing(false), stopping(false) {
+    writer = std::thread(&AsyncSink::writerLoop, this);
+}
+
+AsyncSink::~AsyncSink() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    dataReady.notify_one();
+    writer.join();
+    target->flush();
+}
+
+void AsyncSink::write(const char* data, size_t size) {
+    std::unique_lock<std::mutex> lock(mutex);
+    // Contrapresión: si el escritor se quedó atrás, esperar a que vacíe el buffer
+    drained.wait(lock, [this]() { return pending.size() < maxPending || stopping; });
+    pending.insert(pending.end(), data, data + size);
+    lock.unlock();
+    dataReady.notify_one();
+}
+
+void AsyncSink::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    drained.wait(lock, [this]() { return pending.empty() && !writing; });
+    lock.unlock();
+    target->flush();
+}
+
+void AsyncSink::writerLoop() {
+    std::vector<char> batch;
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (true) {
+        dataReady.wait(lock, [this]() { return !pending.empty() || stopping; });
+        if (pending.empty() && stopping) {
+            return;
+        }
+
+        batch.swap(pending);
+        writing = true;
+        lock.unlock();
+        drained.notify_all();
+
+        target->write(batch.data(), batch.size());
+        batch.clear();
+
+        lock.lock();
+        writing = false;
+        drained.notify_all();
+    }
+}
+
+std::unique_ptr<OutputSink> openFileSink(const std::string& path, bool async) {
+    std::unique_ptr<OutputSink> sink(new FileSink(path));
+    if (async && sink->good()) {
+        sink.reset(new AsyncSink(std::move(sink)));
+    }
+    return sink;
+}
+
+SinkStream::Buffer::Buffer(OutputSink* sink) : sink(sink) {
+    setp(storage, storage + sizeof(storage));
+}
+
+void SinkStream::Buffer::drain() {
+    if (pptr() > pbase()) {
+        sink->write(pbase(), static_cast<size_t>(pptr() - pbase()));
+        setp(storage, storage + sizeof(storage));
+    }
+}
+
+SinkStream::Buffer::int_type SinkStream::Buffer::overflow(int_type c) {
+    drain();
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+    }
+    return traits_type::not_eof(c);
+}
+
+int SinkStream::Buffer::sync() {
+    drain();
+    sink->flush();
+    return 0;
+}
+
+std::streamsize SinkStream::Buffer::xsputn(const char* data, std::streamsize size) {
+    if (size > epptr() - pptr()) {
+        drain();
+        if (size > epptr() - pptr()) {
+            sink->write(data, static_cast<size_t>(size));
+            return size;
+        }
+    }
+    std::char_traits<char>::copy(pptr(), data, static_cast<size_t>(size));
+    pbump(static_cast<int>(size));
+    return size;
+}
+
+SinkStream::SinkStream(std::unique_ptr<OutputSink> sink)
+    : std::ostream(nullptr), sink(std::move(sink)), buffer(this->sink.get()) {
+    rdbuf(&buffer);
+}
+
+SinkStream::~SinkStream() {
+    close();
+}
+
+void SinkStream::close() {
+    if (sink) {
+        buffer.pubsync();
+        rdbuf(nullptr);
+        sink.reset();
+    }
+}
@@ -6,4 +6,39 @@ Parameter::Parameter(std::string name, double probability) : name(name), probabi
 void Parameter::adjustProbability(double adjustment) {
     this->probability += adjustment;
     this->probability = std::max(0.0, std::min(1.0, this->probability));
-}
\ No newline at end of file
+}
+
+ParameterSet::ParameterSet() : layoutVersion(0) {}
+
+void ParameterSet::assign(const std::vector<Parameter>& parameters) {
+    bool sameLayout = parameters.size() == names.size();
+    for (size_t i = 0; sameLayout && i < parameters.size(); ++i) {
+        sameLayout = parameters[i].name == names[i];
+    }
+
+    if (!sameLayout) {
+        names.clear();
+        nameIndex.clear();
+        for (const auto& param : parameters) {
+            nameIndex.insert(std::make_pair(param.name, static_cast<int>(names.size())));
+            names.push_back(param.name);
+        }
+        values.resize(names.size());
+        ++layoutVersion;
+    }
+
+    for (size_t i = 0; i < parameters.size(); ++i) {
+        values[i] = parameters[i].probability;
+    }
+}
+
+void ParameterSet::writeTo(std::vector<Parameter>& parameters) const {
+    for (size_t i = 0; i < parameters.size() && i < values.size(); ++i) {
+        parameters[i].probability = values[i];
+    }
+}
+
+int ParameterSet::indexOf(const std::string& name) const {
+    auto it = nameIndex.find(name);
+    return it == nameIndex.end() ? -1 : it->second;
+}
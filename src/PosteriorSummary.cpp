@@ -0,0 +1,306 @@
+#include "../include/PosteriorSummary.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// Filas por bloque al acumular las ecuaciones normales: las filas del diseño, los pesos y los
+// parámetros de un bloque siguen en L1 mientras se recorren todos sus productos
+const int BLOCK_ROWS = 64;
+// Parámetros por tesela de columnas, para conjuntos de parámetros anchos
+const int BLOCK_PARAMETERS = 8;
+
+const int STATISTICS = PATH_SUMMARY_SIZE + 1;   // estadísticos del camino y la distancia
+
+// Cholesky en sitio de una matriz simétrica definida positiva de n × n (triángulo inferior)
+bool choleskyDecompose(double* matrix, int n) {
+    for (int j = 0; j < n; ++j) {
+        double diagonal = matrix[j * n + j];
+        for (int k = 0; k < j; ++k) {
+            diagonal -= matrix[j * n + k] * matrix[j * n + k];
+        }
+        if (!(diagonal > 0.0)) {
+            return false;
+        }
+        const double pivot = std::sqrt(diagonal);
+        matrix[j * n + j] = pivot;
+        for (int i = j + 1; i < n; ++i) {
+            double value = matrix[i * n + j];
+            for (int k = 0; k < j; ++k) {
+                value -= matrix[i * n + k] * matrix[j * n + k];
+            }
+            matrix[i * n + j] = value / pivot;
+        }
+    }
+    return true;
+}
+
+// Resuelve L Lᵀ x = b para la columna column de un lado derecho de n × width
+void choleskySolve(const double* factor, int n, double* rightHandSide, int width, int column) {
+    for (int i = 0; i < n; ++i) {
+        double value = rightHandSide[i * width + column];
+        for (int k = 0; k < i; ++k) {
+            value -= factor[i * n + k] * rightHandSide[k * width + column];
+        }
+        rightHandSide[i * width + column] = value / factor[i * n + i];
+    }
+    for (int i = n - 1; i >= 0; --i) {
+        double value = rightHandSide[i * width + column];
+        for (int k = i + 1; k < n; ++k) {
+            value -= factor[k * n + i] * rightHandSide[k * width + column];
+        }
+        rightHandSide[i * width + column] = value / factor[i * n + i];
+    }
+}
+
+} // namespace
+
+void PosteriorSummary::scale(double factor) {
+    for (auto& value : mean) {
+        value *= factor;
+    }
+    for (auto& value : lower) {
+        value *= factor;
+    }
+    for (auto& value : upper) {
+        value *= factor;
+    }
+}
+
+PosteriorSummarizer::PosteriorSummarizer()
+    : regressionAdjustment(false), credibleMass(0.95), dimension(0), count(0), columns(0) {}
+
+void PosteriorSummarizer::setCredibleMass(double mass) {
+    this->credibleMass = std::max(0.0, std::min(1.0, mass));
+}
+
+void PosteriorSummarizer::begin(int dimension, int expectedCount) {
+    this->dimension = std::max(0, dimension);
+    this->count = 0;
+    values.clear();
+    summaries.clear();
+    distances.clear();
+    weights.clear();
+
+    const size_t expected = static_cast<size_t>(std::max(0, expectedCount));
+    values.reserve(expected * this->dimension);
+    summaries.reserve(expected * (PATH_SUMMARY_SIZE + 1));
+    distances.reserve(expected);
+    weights.reserve(expected);
+    column.reserve(expected);
+    design.reserve(expected * (PATH_SUMMARY_SIZE + 2));
+}
+
+void PosteriorSummarizer::add(const double* values, const double* summary, double distance, double weight) {
+    this->values.insert(this->values.end(), values, values + dimension);
+    this->summaries.insert(this->summaries.end(), summary, summary + PATH_SUMMARY_SIZE);
+    this->summaries.push_back(distance);
+    this->distances.push_back(distance);
+    this->weights.push_back(weight);
+    ++count;
+}
+
+const PosteriorSummary& PosteriorSummarizer::finish(double bandwidth) {
+    const double missing = std::numeric_limits<double>::quiet_NaN();
+    summary.samples = count;
+    summary.adjusted = false;
+    summary.mean.assign(dimension, missing);
+    summary.lower.assign(dimension, missing);
+    summary.upper.assign(dimension, missing);
+    summary.effectiveSampleSize = 0.0;
+    if (count == 0) {
+        return summary;
+    }
+
+    if (regressionAdjustment) {
+        // Núcleo de Epanechnikov sobre la distancia; si deja todo en 0 se conservan los pesos previos
+        double kernelTotal = 0.0;
+        const bool useKernel = bandwidth > 0.0 && std::isfinite(bandwidth);
+        for (int i = 0; i < count && useKernel; ++i) {
+            const double u = distances[i] / bandwidth;
+            kernelTotal += u < 1.0 ? weights[i] * (1.0 - u * u) : 0.0;
+        }
+        if (kernelTotal > 0.0) {
+            for (int i = 0; i < count; ++i) {
+                const double u = distances[i] / bandwidth;
+                weights[i] *= u < 1.0 ? 1.0 - u * u : 0.0;
+            }
+        }
+        summary.adjusted = fitRegression();
+    }
+
+    double totalWeight = 0.0;
+    double squaredWeights = 0.0;
+    for (int i = 0; i < count; ++i) {
+        totalWeight += weights[i];
+        squaredWeights += weights[i] * weights[i];
+    }
+    if (!(totalWeight > 0.0)) {
+        return summary;
+    }
+    summary.effectiveSampleSize = totalWeight * totalWeight / squaredWeights;
+
+    for (int d = 0; d < dimension; ++d) {
+        double sum = 0.0;
+        for (int i = 0; i < count; ++i) {
+            sum += weights[i] * values[static_cast<size_t>(i) * dimension + d];
+        }
+        summary.mean[d] = sum / totalWeight;
+        weightedQuantiles(d);
+    }
+    return summary;
+}
+
+bool PosteriorSummarizer::fitRegression() {
+    // Estadísticos estandarizados con su desviación ponderada; los constantes (por ejemplo, la
+    // distancia cuando todos los caminos caen dentro de los tramos) no entran en la regresión
+    double totalWeight = 0.0;
+    for (int i = 0; i < count; ++i) {
+        totalWeight += weights[i];
+    }
+    if (!(totalWeight > 0.0)) {
+        return false;
+    }
+
+    int used[STATISTICS];
+    double scales[STATISTICS];
+    int statistics = 0;
+    for (int j = 0; j < STATISTICS; ++j) {
+        double mean = 0.0;
+        for (int i = 0; i < count; ++i) {
+            mean += weights[i] * summaries[static_cast<size_t>(i) * STATISTICS + j];
+        }
+        mean /= totalWeight;
+        double variance = 0.0;
+        for (int i = 0; i < count; ++i) {
+            const double deviation = summaries[static_cast<size_t>(i) * STATISTICS + j] - mean;
+            variance += weights[i] * deviation * deviation;
+        }
+        const double deviation = std::sqrt(variance / totalWeight);
+        if (std::isfinite(deviation) && deviation > 1e-12 * (1.0 + std::fabs(mean))) {
+            used[statistics] = j;
+            scales[statistics] = deviation;
+            ++statistics;
+        }
+    }
+
+    columns = 1 + statistics;
+    if (statistics == 0 || count < columns + 1) {
+        return false;
+    }
+
+    // Diseño centrado en el valor observado (0): la ordenada en el origen es el posterior en s_obs
+    design.resize(static_cast<size_t>(count) * columns);
+    for (int i = 0; i < count; ++i) {
+        double* row = design.data() + static_cast<size_t>(i) * columns;
+        row[0] = 1.0;
+        for (int c = 0; c < statistics; ++c) {
+            row[c + 1] = summaries[static_cast<size_t>(i) * STATISTICS + used[c]] / scales[c];
+        }
+    }
+
+    // Ecuaciones normales Xᵀ W X y Xᵀ W Θ, por bloques de filas y teselas de parámetros
+    gram.assign(static_cast<size_t>(columns) * columns, 0.0);
+    crossProducts.assign(static_cast<size_t>(columns) * dimension, 0.0);
+    for (int rowStart = 0; rowStart < count; rowStart += BLOCK_ROWS) {
+        const int rowEnd = std::min(count, rowStart + BLOCK_ROWS);
+
+        for (int i = rowStart; i < rowEnd; ++i) {
+            const double* x = design.data() + static_cast<size_t>(i) * columns;
+            for (int a = 0; a < columns; ++a) {
+                const double weighted = weights[i] * x[a];
+                for (int b = 0; b <= a; ++b) {
+                    gram[a * columns + b] += weighted * x[b];
+                }
+            }
+        }
+
+        for (int first = 0; first < dimension; first += BLOCK_PARAMETERS) {
+            const int last = std::min(dimension, first + BLOCK_PARAMETERS);
+            for (int i = rowStart; i < rowEnd; ++i) {
+                const double* x = design.data() + static_cast<size_t>(i) * columns;
+                const double* theta = values.data() + static_cast<size_t>(i) * dimension;
+                for (int a = 0; a < columns; ++a) {
+                    const double weighted = weights[i] * x[a];
+                    double* out = crossProducts.data() + static_cast<size_t>(a) * dimension;
+                    for (int d = first; d < last; ++d) {
+                        out[d] += weighted * theta[d];
+                    }
+                }
+            }
+        }
+    }
+
+    // Una cresta mínima evita pivotes nulos con estadísticos casi colineales
+    for (int a = 0; a < columns; ++a) {
+        gram[a * columns + a] += 1e-10 * gram[0];
+    }
+    if (!choleskyDecompose(gram.data(), columns)) {
+        return false;
+    }
+    for (int d = 0; d < dimension; ++d) {
+        choleskySolve(gram.data(), columns, crossProducts.data(), dimension, d);
+    }
+
+    // θ* = θ - β (s - s_obs); crossProducts guarda ahora los coeficientes
+    for (int i = 0; i < count; ++i) {
+        const double* x = design.data() + static_cast<size_t>(i) * columns;
+        double* theta = values.data() + static_cast<size_t>(i) * dimension;
+        for (int d = 0; d < dimension; ++d) {
+            double correction = 0.0;
+            for (int c = 1; c < columns; ++c) {
+                correction += crossProducts[static_cast<size_t>(c) * dimension + d] * x[c];
+            }
+            theta[d] = std::max(0.0, std::min(1.0, theta[d] - correction));
+        }
+    }
+    return true;
+}
+
+void PosteriorSummarizer::weightedQuantiles(int d) {
+    // Columna d contigua, con su peso, para ordenar sin indirecciones
+    column.resize(count);
+    bool uniform = true;
+    for (int i = 0; i < count; ++i) {
+        column[i] = std::make_pair(values[static_cast<size_t>(i) * dimension + d], weights[i]);
+        uniform = uniform && weights[i] == weights[0];
+    }
+
+    const double tailMass = 0.5 * (1.0 - credibleMass);
+
+    if (uniform) {
+        // Pesos iguales: los extremos son los órdenes k con (k + 1) / count >= cola, sin ordenar todo
+        const int lowerRank = std::max(0, static_cast<int>(std::ceil(tailMass * count - 1e-9)) - 1);
+        const int upperRank = std::min(count - 1, std::max(0, static_cast<int>(std::ceil((1.0 - tailMass) * count - 1e-9)) - 1));
+        std::nth_element(column.begin(), column.begin() + upperRank, column.end());
+        summary.upper[d] = column[upperRank].first;
+        std::nth_element(column.begin(), column.begin() + lowerRank, column.begin() + upperRank + 1);
+        summary.lower[d] = column[lowerRank].first;
+        return;
+    }
+
+    std::sort(column.begin(), column.end());
+    double totalWeight = 0.0;
+    for (int i = 0; i < count; ++i) {
+        totalWeight += weights[i];
+    }
+    const double tail = tailMass * totalWeight;
+
+    // Primer valor cuya masa acumulada alcanza cada cola
+    double cumulative = 0.0;
+    bool lowerFound = false;
+    summary.lower[d] = column[0].first;
+    summary.upper[d] = column[count - 1].first;
+    for (int k = 0; k < count; ++k) {
+        cumulative += column[k].second;
+        if (!lowerFound && cumulative >= tail && column[k].second > 0.0) {
+            summary.lower[d] = column[k].first;
+            lowerFound = true;
+        }
+        if (cumulative >= totalWeight - tail && column[k].second > 0.0) {
+            summary.upper[d] = column[k].first;
+            break;
+        }
+    }
+}
@@ -0,0 +1,192 @@
+#include "../include/PriceBatch.h"
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define ABC_HAVE_AVX2_KERNEL 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Kernel escalar: los mismos pasos que simulatePricePath, escritos por columnas.
+// Days > 0 fija el horizonte en tiempo de compilación.
+template <int Days>
+void scalarKernel(const TransitionModel& model, int firstPath, int pathCount, int daysToSimulate,
+                  const RandomEngine& rng, PriceBatch& out) {
+    const int days = Days > 0 ? Days : daysToSimulate;
+
+    for (int p = firstPath; p < pathCount; ++p) {
+        RandomEngine pathEngine = rng.split(p);
+        double* column = out.prices.data() + p;
+
+        int current = model.sampleInitial(pathEngine);
+        for (int d = 0; d < days; ++d) {
+            current = model.sampleNext(current, pathEngine);
+            column[static_cast<size_t>(d) * pathCount] = model.samplePrice(current, pathEngine);
+        }
+    }
+}
+
+#ifdef ABC_HAVE_AVX2_KERNEL
+
+__attribute__((target("avx2")))
+inline __m256i rotlAvx2(__m256i x, int k) {
+    return _mm256_or_si256(_mm256_slli_epi64(x, k), _mm256_srli_epi64(x, 64 - k));
+}
+
+// Cuatro carriles xoshiro256** (mismo algoritmo que RandomEngine)
+struct Avx2Lanes {
+    __m256i s0, s1, s2, s3;
+};
+
+// Un uniforme en [0, 1) por carril, igual que RandomEngine::uniform: (x >> 11) · 2^-53.
+// AVX2 no convierte enteros de 64 bits, así que se arma con los 52 bits altos como mantisa
+// (exacto) más el bit 11 como 2^-53; la suma tiene como mucho 53 bits y también es exacta.
+__attribute__((target("avx2")))
+inline __m256d nextUniform(Avx2Lanes& lanes) {
+    __m256i x = _mm256_add_epi64(_mm256_slli_epi64(lanes.s1, 2), lanes.s1);
+    x = rotlAvx2(x, 7);
+    const __m256i draw = _mm256_add_epi64(_mm256_slli_epi64(x, 3), x);
+
+    const __m256i t = _mm256_slli_epi64(lanes.s1, 17);
+    lanes.s2 = _mm256_xor_si256(lanes.s2, lanes.s0);
+    lanes.s3 = _mm256_xor_si256(lanes.s3, lanes.s1);
+    lanes.s1 = _mm256_xor_si256(lanes.s1, lanes.s2);
+    lanes.s0 = _mm256_xor_si256(lanes.s0, lanes.s3);
+    lanes.s2 = _mm256_xor_si256(lanes.s2, t);
+    lanes.s3 = rotlAvx2(lanes.s3, 45);
+
+    const __m256i exponent = _mm256_set1_epi64x(0x3FF0000000000000LL);
+    const __m256i bit11 = _mm256_set1_epi64x(1LL << 11);
+    const __m256d high = _mm256_sub_pd(
+        _mm256_castsi256_pd(_mm256_or_si256(_mm256_srli_epi64(draw, 12), exponent)), _mm256_set1_pd(1.0));
+    const __m256d low = _mm256_and_pd(
+        _mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_and_si256(draw, bit11), bit11)),
+        _mm256_set1_pd(1.0 / 9007199254740992.0));
+    return _mm256_add_pd(high, low);
+}
+
+// TransitionModel::sampleRow para cuatro filas: columna por truncado, y su parte fraccionaria
+// frente a la probabilidad de aceptación decide entre la columna y su alias
+__attribute__((target("avx2")))
+inline __m128i sampleRows(const TransitionModel& model, __m128i rows, __m256d u) {
+    const int n = model.size();
+    const __m256d scaled = _mm256_mul_pd(u, _mm256_set1_pd(static_cast<double>(n)));
+    const __m128i columns = _mm_min_epi32(_mm256_cvttpd_epi32(scaled), _mm_set1_epi32(n - 1));
+    const __m256d columnValues = _mm256_cvtepi32_pd(columns);
+    const __m256d fraction = _mm256_sub_pd(scaled, columnValues);
+
+    const __m128i slots = _mm_add_epi32(_mm_mullo_epi32(rows, _mm_set1_epi32(n)), columns);
+    const __m256d acceptance = _mm256_mask_i32gather_pd(_mm256_setzero_pd(), model.getAcceptance(), slots,
+                                                        _mm256_castsi256_pd(_mm256_set1_epi64x(-1)), 8);
+    const __m128i aliases = _mm_mask_i32gather_epi32(_mm_setzero_si128(), model.getAliases(), slots,
+                                                     _mm_set1_epi32(-1), 4);
+
+    const __m256d keep = _mm256_cmp_pd(fraction, acceptance, _CMP_LT_OQ);
+    return _mm256_cvttpd_epi32(_mm256_blendv_pd(_mm256_cvtepi32_pd(aliases), columnValues, keep));
+}
+
+// Kernel AVX2: cuatro caminos por iteración, cada carril con su propio estado xoshiro256**
+template <int Days>
+__attribute__((target("avx2")))
+void avx2Kernel(const TransitionModel& model, int pathCount, int daysToSimulate,
+                const RandomEngine& rng, PriceBatch& out) {
+    const int days = Days > 0 ? Days : daysToSimulate;
+    const int vectorPaths = pathCount - pathCount % 4;
+
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d allLanes = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+    const __m128i initialRow = _mm_set1_epi32(model.size());
+    const double* lower = model.getLowers();
+    const double* width = model.getWidths();
+
+    for (int p = 0; p < vectorPaths; p += 4) {
+        alignas(32) std::uint64_t states[4][4];
+        for (int lane = 0; lane < 4; ++lane) {
+            std::uint64_t s[4];
+            rng.split(p + lane).copyState(s);
+            for (int i = 0; i < 4; ++i) {
+                states[i][lane] = s[i];
+            }
+        }
+        Avx2Lanes lanes;
+        lanes.s0 = _mm256_load_si256(reinterpret_cast<const __m256i*>(states[0]));
+        lanes.s1 = _mm256_load_si256(reinterpret_cast<const __m256i*>(states[1]));
+        lanes.s2 = _mm256_load_si256(reinterpret_cast<const __m256i*>(states[2]));
+        lanes.s3 = _mm256_load_si256(reinterpret_cast<const __m256i*>(states[3]));
+
+        double* column = out.prices.data() + p;
+
+        __m128i current = sampleRows(model, initialRow, nextUniform(lanes));
+        for (int d = 0; d < days; ++d) {
+            current = sampleRows(model, current, nextUniform(lanes));
+            const __m256d u = nextUniform(lanes);
+            const __m256d lo = _mm256_mask_i32gather_pd(zero, lower, current, allLanes, 8);
+            const __m256d w = _mm256_mask_i32gather_pd(zero, width, current, allLanes, 8);
+            _mm256_storeu_pd(column + static_cast<size_t>(d) * pathCount, _mm256_add_pd(lo, _mm256_mul_pd(w, u)));
+        }
+    }
+
+    // Caminos restantes (pathCount no múltiplo de 4)
+    scalarKernel<Days>(model, vectorPaths, pathCount, daysToSimulate, rng, out);
+}
+
+#endif // ABC_HAVE_AVX2_KERNEL
+
+template <int Days>
+void runKernel(const TransitionModel& model, int pathCount, int daysToSimulate,
+               const RandomEngine& rng, PriceBatch& out, SimdLevel level) {
+#ifdef ABC_HAVE_AVX2_KERNEL
+    // Los índices de las tablas alias se recogen como enteros de 32 bits
+    const long long cells = static_cast<long long>(model.size() + 1) * model.size();
+    if (level == SimdLevel::AVX2 && cells <= INT_MAX) {
+        avx2Kernel<Days>(model, pathCount, daysToSimulate, rng, out);
+        return;
+    }
+#else
+    (void)level;
+#endif
+    scalarKernel<Days>(model, 0, pathCount, daysToSimulate, rng, out);
+}
+
+} // namespace
+
+SimdLevel detectSimdLevel() {
+#ifdef ABC_HAVE_AVX2_KERNEL
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return SimdLevel::AVX2;
+    }
+#endif
+    return SimdLevel::Scalar;
+}
+
+void simulateModelPriceBatch(const TransitionModel& model,
+                             int pathCount,
+                             int daysToSimulate,
+                             const RandomEngine& rng,
+                             PriceBatch& out,
+                             SimdLevel level) {
+    out.resize(pathCount, daysToSimulate);
+    if (model.empty() || pathCount <= 0 || daysToSimulate <= 0) {
+        return;
+    }
+
+    // Especializaciones para los horizontes más habituales
+    switch (daysToSimulate) {
+        case 7:
+            runKernel<7>(model, pathCount, daysToSimulate, rng, out, level);
+            break;
+        case 30:
+            runKernel<30>(model, pathCount, daysToSimulate, rng, out, level);
+            break;
+        case 90:
+            runKernel<90>(model, pathCount, daysToSimulate, rng, out, level);
+            break;
+        default:
+            runKernel<0>(model, pathCount, daysToSimulate, rng, out, level);
+            break;
+    }
+}
@@ -0,0 +1,31 @@
+#include "../include/RandomEngine.h"
+
+namespace {
+
+std::uint64_t splitmix64(std::uint64_t& x) {
+    std::uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+} // namespace
+
+RandomEngine::RandomEngine(std::uint64_t seed) {
+    seedFromKey(seed);
+}
+
+void RandomEngine::seedFromKey(std::uint64_t key) {
+    this->key = key;
+    std::uint64_t x = key;
+    for (int i = 0; i < 4; ++i) {
+        state[i] = splitmix64(x);
+    }
+}
+
+RandomEngine RandomEngine::split(std::uint64_t streamId) const {
+    std::uint64_t x = key ^ (streamId * 0xD1B54A32D192ED03ULL);
+    RandomEngine child;
+    child.seedFromKey(splitmix64(x));
+    return child;
+}
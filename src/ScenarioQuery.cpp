@@ -0,0 +1,312 @@
+#include "../include/ScenarioQuery.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <sstream>
+#include "../include/FastParse.h"
+#include "../include/Logger.h"
+
+namespace {
+
+// Días simulados por petición (días × caminos), para acotar la latencia de una petición
+const long long MAX_QUERY_STEPS = 1LL << 30;
+
+const double LOWER_QUANTILE = 0.05;
+const double UPPER_QUANTILE = 0.95;
+
+bool parseWholeDouble(const std::string& text, double& value) {
+    const char* p = text.data();
+    const char* end = p + text.size();
+    return parseDouble(p, end, value) && p == end;
+}
+
+bool parseWholeInt(const std::string& text, long long& value) {
+    const char* p = text.data();
+    const char* end = p + text.size();
+    return parseInt(p, end, value) && p == end;
+}
+
+void appendNumber(std::string& line, double value) {
+    char number[32];
+    int length = std::snprintf(number, sizeof(number), "%g", value);
+    line.append(number, static_cast<size_t>(length));
+}
+
+} // namespace
+
+bool parseScenarioRequest(const std::string& line, int defaultDays, int defaultPaths,
+                          ScenarioRequest& request, std::string& error) {
+    request.id.clear();
+    request.overrides.clear();
+    request.days = defaultDays;
+    request.paths = defaultPaths;
+    request.hasSeed = false;
+    request.seed = 0;
+
+    std::istringstream tokens(line);
+    std::string token;
+    while (tokens >> token) {
+        const size_t separator = token.find('=');
+        if (separator == std::string::npos || separator == 0) {
+            error = "expected key=value, found '" + token + "'";
+            return false;
+        }
+        const std::string key = token.substr(0, separator);
+        const std::string value = token.substr(separator + 1);
+
+        long long integer = 0;
+        double number = 0.0;
+        if (key == "id") {
+            request.id = value;
+        } else if (key == "days" || key == "paths") {
+            if (!parseWholeInt(value, integer) || integer <= 0 || integer > MAX_QUERY_STEPS) {
+                error = "invalid " + key + " '" + value + "'";
+                return false;
+            }
+            (key == "days" ? request.days : request.paths) = static_cast<int>(integer);
+        } else if (key == "seed") {
+            if (!parseWholeInt(value, integer)) {
+                error = "invalid seed '" + value + "'";
+                return false;
+            }
+            request.hasSeed = true;
+            request.seed = static_cast<unsigned long long>(integer);
+        } else if (parseWholeDouble(value, number) && std::isfinite(number)) {
+            request.overrides.push_back(std::make_pair(key, number));
+        } else {
+            error = "invalid value for feature " + key + " '" + value + "'";
+            return false;
+        }
+    }
+    return true;
+}
+
+ScenarioForecaster::ScenarioForecaster() : queryCounter(0), loaded(false) {}
+
+bool ScenarioForecaster::load(const SKUData& skuData,
+                              const std::map<std::string, double>& normalizedFeatures,
+                              const std::vector<Parameter>& parameters) {
+    loaded = false;
+    if (skuData.listProducts.empty()) {
+        LOG_ERROR("SKU " << skuData.sku << " has no price intervals to forecast from");
+        return false;
+    }
+
+    this->skuData = skuData;
+    this->parameters.assign(parameters);
+    calibratedFeatures.bind(this->parameters, normalizedFeatures);
+    calibratedModel.build(this->skuData, calibratedFeatures, this->parameters.probabilities());
+
+    // Capacidad para una feature por parámetro: añadir una feature ausente no reserva memoria
+    scenarioFeatures.parameterIndex.reserve(this->parameters.size());
+    scenarioFeatures.values.reserve(this->parameters.size());
+
+    // Los mismos tramos que usa el modelo de transición, con sus extremos ordenados
+    const int intervalCount = static_cast<int>(this->skuData.listProducts.size());
+    breakpoints.clear();
+    densities.resize(intervalCount);
+    midpoints.resize(intervalCount);
+    for (int j = 0; j < intervalCount; ++j) {
+        const double low = this->skuData.listProducts[j].first;
+        const double width = this->skuData.listProducts[j].second - low;
+        midpoints[j] = low + 0.5 * width;
+        if (width > 0.0) {
+            densities[j] = 1.0 / width;
+            breakpoints.push_back({low, j, 1});
+            breakpoints.push_back({low + width, j, -1});
+        } else {
+            densities[j] = 0.0;
+            breakpoints.push_back({low, j, 0});
+        }
+    }
+    std::sort(breakpoints.begin(), breakpoints.end(),
+              [](const Breakpoint& a, const Breakpoint& b) { return a.price < b.price; });
+    loaded = true;
+    return true;
+}
+
+void ScenarioForecaster::setSeed(unsigned long long seed) {
+    masterEngine = RandomEngine(seed);
+    queryCounter = 0;
+}
+
+bool ScenarioForecaster::forecast(const ScenarioRequest& request, ScenarioForecast& result) {
+    auto start = std::chrono::steady_clock::now();
+
+    if (!loaded) {
+        LOG_ERROR("Scenario forecaster has no calibrated SKU");
+        return false;
+    }
+    if (request.days <= 0 || request.paths <= 0 ||
+        static_cast<long long>(request.days) * request.paths > MAX_QUERY_STEPS) {
+        LOG_WARNING("Query " << request.id << ": " << request.days << " days x " << request.paths
+                    << " paths is out of range (at most " << MAX_QUERY_STEPS << " simulated days)");
+        return false;
+    }
+
+    // Sin cambios de features se reutiliza el modelo calibrado tal cual
+    const TransitionModel* model = &calibratedModel;
+    if (!request.overrides.empty()) {
+        scenarioFeatures.parameterIndex.assign(calibratedFeatures.parameterIndex.begin(),
+                                               calibratedFeatures.parameterIndex.end());
+        scenarioFeatures.values.assign(calibratedFeatures.values.begin(), calibratedFeatures.values.end());
+        for (const auto& feature : request.overrides) {
+            const int parameter = parameters.indexOf(feature.first);
+            if (parameter < 0) {
+                LOG_WARNING("Query " << request.id << ": feature " << feature.first << " has no calibrated parameter");
+                return false;
+            }
+            auto slot = std::find(scenarioFeatures.parameterIndex.begin(), scenarioFeatures.parameterIndex.end(), parameter);
+            if (slot != scenarioFeatures.parameterIndex.end()) {
+                scenarioFeatures.values[slot - scenarioFeatures.parameterIndex.begin()] = feature.second;
+            } else {
+                scenarioFeatures.parameterIndex.push_back(parameter);
+                scenarioFeatures.values.push_back(feature.second);
+            }
+        }
+        scenarioModel.build(skuData, scenarioFeatures, parameters.probabilities());
+        model = &scenarioModel;
+    }
+
+    // Camino a camino, con el generador en registros; el camino p usa el subflujo p de la petición
+    const RandomEngine queryEngine = request.hasSeed ? RandomEngine(request.seed) : masterEngine.split(queryCounter++);
+    const int paths = request.paths;
+    const int days = request.days;
+    const int intervalCount = model->size();
+    counts.assign(static_cast<size_t>(days) * intervalCount, 0);
+    for (int p = 0; p < paths; ++p) {
+        RandomEngine rng = queryEngine.split(static_cast<std::uint64_t>(p));
+        int current = model->sampleInitial(rng);
+        int* dayCounts = counts.data();
+        for (int d = 0; d < days; ++d, dayCounts += intervalCount) {
+            current = model->sampleNext(current, rng);
+            ++dayCounts[current];
+        }
+    }
+
+    result.id = request.id;
+    result.days = days;
+    result.paths = paths;
+    result.drift = model->getDrift();
+    result.mean.resize(days);
+    result.lower.resize(days);
+    result.median.resize(days);
+    result.upper.resize(days);
+    double quantiles[3];
+    for (int d = 0; d < days; ++d) {
+        mixtureBands(counts.data() + static_cast<size_t>(d) * intervalCount, paths, result.mean[d], quantiles);
+        result.lower[d] = quantiles[0];
+        result.median[d] = quantiles[1];
+        result.upper[d] = quantiles[2];
+    }
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+void ScenarioForecaster::mixtureBands(const int* counts, int paths, double& mean, double* quantiles) const {
+    static const double targets[3] = {LOWER_QUANTILE, 0.5, UPPER_QUANTILE};
+    const double scale = 1.0 / paths;
+
+    mean = 0.0;
+    for (size_t j = 0; j < midpoints.size(); ++j) {
+        mean += counts[j] * midpoints[j];
+    }
+    mean *= scale;
+
+    // La acumulada de la mezcla es lineal a trozos entre extremos consecutivos: su pendiente
+    // cambia en cada inicio y fin de tramo, y los tramos de ancho 0 la hacen saltar
+    double cumulative = 0.0;
+    double slope = 0.0;
+    double previous = breakpoints.front().price;
+    int k = 0;
+    for (const auto& point : breakpoints) {
+        const double reached = cumulative + slope * (point.price - previous);
+        while (k < 3 && slope > 0.0 && targets[k] <= reached) {
+            quantiles[k] = previous + (targets[k] - cumulative) / slope;
+            ++k;
+        }
+        cumulative = reached;
+        previous = point.price;
+        if (k == 3) {
+            return;
+        }
+
+        const double weight = counts[point.interval] * scale;
+        if (point.kind == 0) {
+            cumulative += weight;
+            while (k < 3 && targets[k] <= cumulative) {
+                quantiles[k++] = point.price;
+            }
+        } else {
+            slope += point.kind * weight * densities[point.interval];
+        }
+    }
+    // Solo por redondeo: la masa total es 1
+    while (k < 3) {
+        quantiles[k++] = previous;
+    }
+}
+
+ScenarioServeSummary serveScenarioQueries(ScenarioForecaster& forecaster,
+                                          std::istream& input,
+                                          OutputSink& output,
+                                          int defaultDays,
+                                          int defaultPaths) {
+    ScenarioServeSummary summary;
+    ScenarioRequest request;
+    ScenarioForecast forecast;
+    std::string line;
+    std::string row;
+    std::string error;
+
+    const std::string header = "Query,Day,Mean,Lower,Median,Upper\n";
+    output.write(header.data(), header.size());
+    output.flush();
+
+    int lineNumber = 0;
+    while (std::getline(input, line)) {
+        ++lineNumber;
+        const size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#') {
+            continue;
+        }
+
+        if (!parseScenarioRequest(line, defaultDays, defaultPaths, request, error)) {
+            LOG_WARNING("Query line " << lineNumber << ": " << error);
+            ++summary.failed;
+            continue;
+        }
+        if (request.id.empty()) {
+            request.id = std::to_string(lineNumber);
+        }
+        if (!forecaster.forecast(request, forecast)) {
+            ++summary.failed;
+            continue;
+        }
+
+        row.clear();
+        for (int d = 0; d < forecast.days; ++d) {
+            row += forecast.id;
+            row += ',';
+            appendNumber(row, d + 1);
+            row += ',';
+            appendNumber(row, forecast.mean[d]);
+            row += ',';
+            appendNumber(row, forecast.lower[d]);
+            row += ',';
+            appendNumber(row, forecast.median[d]);
+            row += ',';
+            appendNumber(row, forecast.upper[d]);
+            row += '\n';
+        }
+        output.write(row.data(), row.size());
+        output.flush();
+
+        ++summary.answered;
+        summary.totalSeconds += forecast.seconds;
+        summary.maxSeconds = std::max(summary.maxSeconds, forecast.seconds);
+    }
+    return summary;
+}
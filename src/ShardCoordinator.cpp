@@ -0,0 +1,398 @@
+#include "../include/ShardCoordinator.h"
+#include "../include/Logger.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <dirent.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+bool sendAll(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        // MSG_NOSIGNAL: un trabajador caído no debe matar al coordinador con SIGPIPE
+        ssize_t count = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        sent += static_cast<size_t>(count);
+    }
+    return true;
+}
+
+// Añade a buffer lo disponible en fd; false en fin de archivo o error
+bool receive(int fd, std::string& buffer) {
+    char chunk[4096];
+    for (;;) {
+        ssize_t count = read(fd, chunk, sizeof(chunk));
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            return false;
+        }
+        buffer.append(chunk, static_cast<size_t>(count));
+        return true;
+    }
+}
+
+bool nextLine(std::string& buffer, std::string& line) {
+    size_t end = buffer.find('\n');
+    if (end == std::string::npos) {
+        return false;
+    }
+    line = buffer.substr(0, end);
+    buffer.erase(0, end + 1);
+    return true;
+}
+
+std::vector<std::string> splitFields(const std::string& line) {
+    std::vector<std::string> fields;
+    std::istringstream stream(line);
+    std::string field;
+    while (std::getline(stream, field, '\t')) {
+        fields.push_back(field);
+    }
+    return fields;
+}
+
+// Los campos no pueden contener los separadores del protocolo
+std::string protocolField(std::string value) {
+    std::replace(value.begin(), value.end(), '\t', ' ');
+    std::replace(value.begin(), value.end(), '\n', ' ');
+    std::replace(value.begin(), value.end(), '\r', ' ');
+    return value;
+}
+
+const char* statusName(const SKUResult& result) {
+    return !result.succeeded ? "failed" : result.skipped ? "skipped" : "ok";
+}
+
+std::vector<std::string> listDirectory(const std::string& directory) {
+    std::vector<std::string> names;
+    DIR* dir = opendir(directory.c_str());
+    if (dir == nullptr) {
+        return names;
+    }
+    while (struct dirent* entry = readdir(dir)) {
+        std::string name = entry->d_name;
+        if (name != "." && name != "..") {
+            names.push_back(name);
+        }
+    }
+    closedir(dir);
+    return names;
+}
+
+// Archivos de salida de un SKU: <prefijo>_<SKU>.<extensión>
+bool belongsTo(const std::string& name, const std::string& sku) {
+    const std::string marker = "_" + sku + ".";
+    size_t position = name.rfind(marker);
+    return position != std::string::npos && name.find('.', position + marker.size()) == std::string::npos;
+}
+
+} // namespace
+
+ShardCoordinator::ShardCoordinator(const std::vector<std::string>& workerCommand,
+                                   const std::string& outputDirectory,
+                                   const ShardSettings& settings)
+    : workerCommand(workerCommand), outputDirectory(outputDirectory), settings(settings) {
+    this->settings.workers = std::max(1, settings.workers);
+    this->settings.maxAttempts = std::max(1, settings.maxAttempts);
+}
+
+BatchSummary ShardCoordinator::run(const std::vector<SKUJob>& jobs) {
+    BatchSummary summary;
+    summary.results.resize(jobs.size());
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        summary.results[i].sku = jobs[i].sku;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::deque<int> pending;
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        pending.push_back(static_cast<int>(i));
+    }
+    std::vector<int> attempts(jobs.size(), 0);
+    std::vector<bool> finished(jobs.size(), false);
+    size_t finishedCount = 0;
+    int failedCount = 0;
+
+    auto finish = [&](int id, const SKUResult& result) {
+        summary.results[id] = result;
+        finished[id] = true;
+        ++finishedCount;
+        failedCount += result.succeeded ? 0 : 1;
+        LOG_INFO("Progress: " << finishedCount << "/" << jobs.size() << " SKUs (" << failedCount << " failed, "
+                 << summary.requeued << " requeued)");
+    };
+
+    const int workerCount = std::max(1, std::min(settings.workers, static_cast<int>(jobs.size())));
+    std::vector<Worker> workers(workerCount);
+    std::vector<bool> alive(workerCount, false);
+    for (int slot = 0; slot < workerCount && !jobs.empty(); ++slot) {
+        alive[slot] = spawn(slot, workers[slot]);
+    }
+
+    while (finishedCount < jobs.size()) {
+        for (int slot = 0; slot < workerCount; ++slot) {
+            if (alive[slot] && workers[slot].job < 0 && !pending.empty()) {
+                int id = pending.front();
+                pending.pop_front();
+                ++attempts[id];
+                // Si el envío falla, el trabajador está muriendo y poll lo informará abajo
+                dispatch(workers[slot], jobs[id], id);
+            }
+        }
+
+        std::vector<pollfd> descriptors;
+        std::vector<int> slots;
+        for (int slot = 0; slot < workerCount; ++slot) {
+            if (alive[slot]) {
+                pollfd descriptor = {workers[slot].fd, POLLIN, 0};
+                descriptors.push_back(descriptor);
+                slots.push_back(slot);
+            }
+        }
+        if (descriptors.empty()) {
+            LOG_ERROR("No worker processes left, " << pending.size() << " SKUs not calibrated");
+            break;
+        }
+
+        if (poll(descriptors.data(), descriptors.size(), -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOG_ERROR("Error: poll failed while waiting for workers");
+            break;
+        }
+
+        for (size_t d = 0; d < descriptors.size(); ++d) {
+            if (descriptors[d].revents == 0) {
+                continue;
+            }
+            const int slot = slots[d];
+            Worker& worker = workers[slot];
+            const bool open = receive(worker.fd, worker.buffer);
+
+            std::string line;
+            while (nextLine(worker.buffer, line)) {
+                std::vector<std::string> fields = splitFields(line);
+                if (fields.size() < 4 || fields[0] != "DONE" || std::atoi(fields[1].c_str()) != worker.job ||
+                    worker.job < 0) {
+                    LOG_WARNING("Unexpected message from worker " << slot << ": " << line);
+                    continue;
+                }
+                const int id = worker.job;
+                SKUResult result;
+                result.sku = jobs[id].sku;
+                result.succeeded = fields[2] != "failed";
+                result.skipped = fields[2] == "skipped";
+                result.seconds = std::atof(fields[3].c_str());
+                result.message = fields.size() > 4 ? fields[4] : "";
+                publish(worker, result.sku, true);
+                worker.job = -1;
+                finish(id, result);
+            }
+
+            if (open) {
+                continue;
+            }
+
+            const std::string cause = reap(worker);
+            alive[slot] = false;
+            if (worker.job < 0) {
+                LOG_WARNING("Worker " << slot << " stopped while idle: " << cause);
+            } else {
+                const int id = worker.job;
+                worker.job = -1;
+                publish(worker, jobs[id].sku, false);
+                if (attempts[id] < settings.maxAttempts) {
+                    LOG_WARNING("SKU " << jobs[id].sku << ": " << cause << ", requeuing (attempt " << attempts[id]
+                                << " of " << settings.maxAttempts << ")");
+                    pending.push_front(id);
+                    ++summary.requeued;
+                } else {
+                    LOG_ERROR("SKU " << jobs[id].sku << ": " << cause << " after " << attempts[id] << " attempts");
+                    SKUResult result;
+                    result.sku = jobs[id].sku;
+                    result.message = cause;
+                    finish(id, result);
+                }
+            }
+            // Un trabajador nuevo ocupa el hueco del caído, tuviera o no un SKU en curso
+            if (!pending.empty()) {
+                alive[slot] = spawn(slot, worker);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        if (!finished[i]) {
+            summary.results[i].succeeded = false;
+            summary.results[i].message = "no worker process available";
+        }
+    }
+
+    // Al cerrar el socket los trabajadores libres terminan
+    for (int slot = 0; slot < workerCount; ++slot) {
+        if (alive[slot]) {
+            reap(workers[slot]);
+        }
+        if (!workers[slot].directory.empty()) {
+            for (const auto& name : listDirectory(workers[slot].directory)) {
+                std::remove((workers[slot].directory + "/" + name).c_str());
+            }
+            rmdir(workers[slot].directory.c_str());
+        }
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    summary.seconds = std::chrono::duration<double>(end - start).count();
+
+    finishBatchSummary(summary, outputDirectory);
+    return summary;
+}
+
+bool ShardCoordinator::spawn(int slot, Worker& worker) {
+    worker.slot = slot;
+    worker.pid = -1;
+    worker.fd = -1;
+    worker.job = -1;
+    worker.buffer.clear();
+    worker.directory = outputDirectory + "/shard_" + std::to_string(slot);
+
+    if (mkdir(worker.directory.c_str(), 0755) != 0 && errno != EEXIST) {
+        LOG_ERROR("Error: Could not create worker directory " << worker.directory);
+        return false;
+    }
+
+    int sockets[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sockets) != 0) {
+        LOG_ERROR("Error: Could not create socket for worker " << slot);
+        return false;
+    }
+
+    // argv se prepara antes de fork: entre fork y exec solo se usan llamadas seguras
+    std::vector<std::string> arguments = workerCommand;
+    arguments.push_back("--worker-fd");
+    arguments.push_back(std::to_string(sockets[1]));
+    arguments.push_back("--output");
+    arguments.push_back(worker.directory);
+    std::vector<char*> argv;
+    for (auto& argument : arguments) {
+        argv.push_back(&argument[0]);
+    }
+    argv.push_back(nullptr);
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        LOG_ERROR("Error: Could not start worker " << slot);
+        close(sockets[0]);
+        close(sockets[1]);
+        return false;
+    }
+    if (pid == 0) {
+        // Solo el extremo del trabajador sobrevive a exec
+        fcntl(sockets[1], F_SETFD, 0);
+        execv("/proc/self/exe", argv.data());
+        _exit(127);
+    }
+
+    close(sockets[1]);
+    worker.pid = pid;
+    worker.fd = sockets[0];
+    LOG_DEBUG("Worker " << slot << " started with pid " << pid);
+    return true;
+}
+
+bool ShardCoordinator::dispatch(Worker& worker, const SKUJob& job, int id) {
+    worker.job = id;
+    std::ostringstream message;
+    message << "JOB\t" << id << '\t' << protocolField(job.sku) << '\t' << protocolField(job.intervalsPath) << '\t'
+            << protocolField(job.featuresPath) << '\n';
+    return sendAll(worker.fd, message.str());
+}
+
+std::string ShardCoordinator::reap(Worker& worker) {
+    if (worker.fd >= 0) {
+        close(worker.fd);
+        worker.fd = -1;
+    }
+
+    std::string cause = "worker stopped";
+    if (worker.pid > 0) {
+        int status = 0;
+        while (waitpid(worker.pid, &status, 0) < 0 && errno == EINTR) {
+        }
+        if (WIFSIGNALED(status)) {
+            cause = "worker killed by signal " + std::to_string(WTERMSIG(status));
+        } else if (WIFEXITED(status)) {
+            cause = "worker exited with code " + std::to_string(WEXITSTATUS(status));
+        }
+        worker.pid = -1;
+    }
+    return cause;
+}
+
+void ShardCoordinator::publish(const Worker& worker, const std::string& sku, bool keep) {
+    for (const auto& name : listDirectory(worker.directory)) {
+        if (!belongsTo(name, sku)) {
+            continue;
+        }
+        const std::string source = worker.directory + "/" + name;
+        if (!keep) {
+            // Salida parcial de un intento fallido
+            std::remove(source.c_str());
+        } else if (std::rename(source.c_str(), (outputDirectory + "/" + name).c_str()) != 0) {
+            LOG_WARNING("Could not move " << source << " to " << outputDirectory);
+        }
+    }
+}
+
+int runShardWorker(const SimulationConfig& config, const std::string& outputDirectory, int fd) {
+    BatchRunner runner(config, outputDirectory);
+    std::string buffer;
+    std::string line;
+
+    while (receive(fd, buffer)) {
+        while (nextLine(buffer, line)) {
+            std::vector<std::string> fields = splitFields(line);
+            if (fields.size() != 5 || fields[0] != "JOB") {
+                LOG_WARNING("Unexpected message from coordinator: " << line);
+                continue;
+            }
+
+            SKUJob job;
+            job.sku = fields[2];
+            job.intervalsPath = fields[3];
+            job.featuresPath = fields[4];
+            SKUResult result = runner.runJob(job);
+
+            std::ostringstream reply;
+            reply << "DONE\t" << fields[1] << '\t' << statusName(result) << '\t' << result.seconds << '\t'
+                  << protocolField(result.message) << '\n';
+            if (!sendAll(fd, reply.str())) {
+                close(fd);
+                return 1;
+            }
+        }
+    }
+
+    close(fd);
+    return 0;
+}
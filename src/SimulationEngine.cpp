@@ -1,10 +1,34 @@
 #include "../include/SimulationEngine.h"
-#include <iostream>
-#include <fstream>
+#include "../include/ABCSMC.h"
+#include "../include/AllocationCounter.h"
+#include "../include/Logger.h"
+#include "../include/OutputSink.h"
 #include <algorithm>
-#include <numeric>
+#include <chrono>
+#include <limits>
+#include <iterator>
+#include <memory>
 
-SimulationEngine::SimulationEngine() {}
+namespace {
+
+// Cuantiles por día del resumen final
+const double DAY_QUANTILES[] = {0.05, 0.5, 0.95};
+
+} // namespace
+
+SimulationEngine::SimulationEngine()
+    : sampler(SamplerType::Rejection),
+      logPath("../data/output/simulation_log.txt"),
+      statsPath("../data/output/statistics_simulations.txt"),
+      statsFormat(StatsFormat::CSV),
+      asyncOutput(false),
+      bufferedOutput(false),
+      warmStartIterations(0),
+      seeded(false),
+      skipped(false),
+      warmStarted(false) {
+    abcMethod.setMetrics(&metrics);
+}
 
 void SimulationEngine::addParameter(const Parameter& parameter) {
     this->parameters.push_back(parameter);
@@ -12,6 +36,7 @@ void SimulationEngine::addParameter(const Parameter& parameter) {
 
 void SimulationEngine::setProductData(const SKUData& data) {
     this->skuData = data;
+    buildIntervalIndex(this->skuData);
 }
 
 void SimulationEngine::setNormalizedFeatures(const std::map<std::string, double>& features) {
@@ -21,106 +46,415 @@ void SimulationEngine::setNormalizedFeatures(const std::map<std::string, double>
     }
 }
 
-void SimulationEngine::runSimulations(int numberOfIterations, int daysToSimulate, double tolerance) {
-    std::ofstream logFile("../data/output/simulation_log.txt");
-    std::ofstream statsFile("../data/output/statistics_simulations.txt");
+void SimulationEngine::setNumberOfThreads(int threads) {
+    this->abcMethod.setNumberOfThreads(threads);
+}
+
+void SimulationEngine::setNumberOfSimulations(int simulations) {
+    this->abcMethod.setNumberOfSimulations(simulations);
+}
+
+void SimulationEngine::setSeed(unsigned long long seed) {
+    this->abcMethod.setSeed(seed);
+    this->seeded = true;
+}
+
+void SimulationEngine::setSampler(SamplerType sampler) {
+    this->sampler = sampler;
+}
+
+void SimulationEngine::setDistanceMetric(DistanceMetricType type) {
+    this->abcMethod.setDistanceMetric(type);
+}
+
+void SimulationEngine::setRegressionAdjustment(bool enabled) {
+    this->abcMethod.setRegressionAdjustment(enabled);
+}
+
+void SimulationEngine::setSMCSettings(const SMCSettings& settings) {
+    this->smcSettings = settings;
+}
+
+void SimulationEngine::setOutputPaths(const std::string& logPath, const std::string& statsPath) {
+    this->logPath = logPath;
+    this->statsPath = statsPath;
+}
+
+void SimulationEngine::setOutputOptions(StatsFormat format, bool asyncOutput) {
+    this->statsFormat = format;
+    this->asyncOutput = asyncOutput;
+}
+
+void SimulationEngine::setMetricsPath(const std::string& path) {
+    this->metricsPath = path;
+    this->metrics.setEnabled(!path.empty());
+}
+
+void SimulationEngine::setBufferedOutput(bool buffered) {
+    this->bufferedOutput = buffered;
+}
+
+void SimulationEngine::takeBufferedOutput(std::string& log, std::string& stats) {
+    log.swap(logBuffer);
+    stats.swap(statsBuffer);
+    logBuffer.clear();
+    statsBuffer.clear();
+}
+
+std::unique_ptr<OutputSink> SimulationEngine::openOutput(const std::string& path, std::string& buffer) {
+    if (bufferedOutput) {
+        buffer.clear();
+        return std::unique_ptr<OutputSink>(new MemorySink(&buffer));
+    }
+    return openFileSink(path, asyncOutput);
+}
+
+void SimulationEngine::setPathHistoryPath(const std::string& path) {
+    this->pathHistoryPath = path;
+}
+
+void SimulationEngine::recordLoadTime(double seconds) {
+    if (metrics.isEnabled()) {
+        metrics.addStage(0, MetricStage::Load, static_cast<long long>(seconds * 1e9));
+    }
+}
+
+void SimulationEngine::setCheckpointPath(const std::string& path) {
+    this->checkpointPath = path;
+}
+
+void SimulationEngine::setWarmStartIterations(int iterations) {
+    this->warmStartIterations = std::max(0, iterations);
+}
+
+bool SimulationEngine::runSimulations(int numberOfIterations, int daysToSimulate, double tolerance) {
+    auto runStart = std::chrono::steady_clock::now();
+    skipped = false;
+    warmStarted = false;
+
+    PosteriorCheckpoint checkpoint;
+    bool hasCheckpoint = false;
+    std::uint64_t contentHash = 0;
+    if (!checkpointPath.empty()) {
+        CalibrationSettings settings;
+        settings.numberOfIterations = numberOfIterations;
+        settings.warmStartIterations = warmStartIterations;
+        settings.daysToSimulate = daysToSimulate;
+        settings.tolerance = tolerance;
+        settings.numberOfSimulations = abcMethod.getNumberOfSimulations();
+        settings.hasSeed = seeded;
+        settings.seed = seeded ? abcMethod.getSeed() : 0;
+        settings.sampler = sampler;
+        settings.smc = smcSettings;
+        settings.distanceMetric = abcMethod.getDistanceMetric();
+        settings.regressionAdjustment = abcMethod.getRegressionAdjustment();
+        contentHash = hashCalibrationInputs(skuData, normalizedFeatures, settings);
+        hasCheckpoint = loadCheckpoint(checkpointPath, checkpoint) && checkpoint.sku == skuData.sku;
+        if (hasCheckpoint && checkpoint.contentHash == contentHash) {
+            applyCheckpoint(checkpoint);
+            skipped = true;
+            LOG_INFO("SKU " << skuData.sku << " unchanged since checkpoint " << checkpointPath << ", skipping calibration");
+            return writeSkippedLog(checkpoint);
+        }
+    }
+
+    SinkStream logFile(openOutput(logPath, logBuffer));
+    StatsWriter statsFile(openOutput(statsPath, statsBuffer), statsFormat);
+
+    if (!logFile.isOpen() || !statsFile.isOpen()) {
+        LOG_ERROR("Error: Could not open output files for writing (" << logPath << ", " << statsPath << ")");
+        return false;
+    }
 
-    if (!logFile.is_open() || !statsFile.is_open()) {
-        std::cerr << "Error: Could not open output files for writing" << std::endl;
-        return;
+    bool sameParameters = false;
+    if (hasCheckpoint) {
+        // El posterior anterior ya está cerca: basta con unas pocas iteraciones para absorber los datos nuevos
+        sameParameters = applyCheckpoint(checkpoint);
+        warmStarted = true;
+        numberOfIterations = std::min(numberOfIterations,
+                                      warmStartIterations > 0 ? warmStartIterations : std::max(1, numberOfIterations / 4));
+        logFile << "Warm start from checkpoint " << checkpointPath << " (previous tolerance "
+                << checkpoint.tolerance << ", " << checkpoint.iterations << " iterations)\n";
     }
 
     logFile << "Starting simulation with " << numberOfIterations << " iterations, "
-            << daysToSimulate << " days to simulate, and tolerance " << tolerance << std::endl;
-    logFile.flush();
+            << daysToSimulate << " days to simulate, and tolerance " << tolerance << '\n';
 
-    statsFile << "Iteration,AverageSaleValue,MinSaleValue,MaxSaleValue,Distance,Tolerance";
+    // Allocations: reservas de memoria de toda la iteración; NaN sin ABC_COUNT_ALLOCATIONS
+    std::vector<std::string> statsColumns = {"Iteration", "AverageSaleValue", "MinSaleValue", "MaxSaleValue",
+                                             "Distance", "Tolerance", "Allocations"};
+    const size_t parameterColumn = statsColumns.size();
     for (const auto& param : parameters) {
-        statsFile << "," << param.name;
+        statsColumns.push_back(param.name);
     }
-    statsFile << std::endl;
+    // Resumen del posterior de la ronda: tamaño de muestra efectivo e intervalo de credibilidad al 95%
+    statsColumns.push_back("EffectiveSampleSize");
+    for (const auto& param : parameters) {
+        statsColumns.push_back(param.name + "Lower");
+        statsColumns.push_back(param.name + "Upper");
+    }
+    statsFile.writeHeader(statsColumns);
+    std::vector<double> statsRow(statsColumns.size());
 
-    std::vector<std::vector<double>> allSimulatedPrices;
-    std::vector<double> bestSimulation;
+    // Resumen en línea: la memoria es O(días) sin importar el número de iteraciones
+    pathStatistics.reset(daysToSimulate, std::vector<double>(std::begin(DAY_QUANTILES), std::end(DAY_QUANTILES)));
+    bestSimulation.clear();
     double bestDistance = std::numeric_limits<double>::max();
 
+    std::unique_ptr<StatsWriter> pathHistory;
+    std::vector<double> pathRow;
+    if (!pathHistoryPath.empty()) {
+        pathHistory.reset(new StatsWriter(openFileSink(pathHistoryPath, asyncOutput), statsFormat));
+        if (pathHistory->isOpen()) {
+            std::vector<std::string> pathColumns = {"Iteration"};
+            for (int d = 0; d < daysToSimulate; ++d) {
+                pathColumns.push_back("Day" + std::to_string(d + 1));
+            }
+            pathHistory->writeHeader(pathColumns);
+            pathRow.resize(pathColumns.size());
+        } else {
+            LOG_WARNING("Could not open path history file " << pathHistoryPath);
+            pathHistory.reset();
+        }
+    }
+
+    ABCSMC smc(abcMethod, smcSettings);
+    if (sampler == SamplerType::SMC) {
+        if (sameParameters && checkpoint.particles.size() > 0) {
+            smc.initializeFrom(checkpoint.particles, parameters, skuData, normalizedFeatures, daysToSimulate, tolerance);
+        } else {
+            smc.initialize(parameters, skuData, normalizedFeatures, daysToSimulate, tolerance);
+        }
+        smc.writePosteriorMean(parameters);
+        logFile << "ABC-SMC initial population of " << smc.getPopulation().size()
+                << " particles, tolerance " << smc.getTolerance() << '\n';
+    }
+
+    int completedIterations = 0;
+    double finalTolerance = tolerance;
     for (int i = 0; i < numberOfIterations; ++i) {
-        logFile << "Iteration " << i + 1 << " of " << numberOfIterations << std::endl;
+        logFile << "Iteration " << i + 1 << " of " << numberOfIterations << '\n';
+        auto iterationStart = std::chrono::steady_clock::now();
+
+        double currentTolerance = tolerance;
+        bool samplerStopped = false;
+        // Reservas de este hilo en la iteración más las de los hilos de trabajo del muestreo
+        const unsigned long long allocationsBefore = AllocationCounter::threadCount();
+        unsigned long long workerAllocations = 0;
 
-        abcMethod.refineParameters(parameters, skuData, normalizedFeatures, daysToSimulate, tolerance);
+        if (sampler == SamplerType::SMC) {
+            // ABC-SMC reparte sus intentos en los hilos de ABCMethod: se cuenta todo el proceso
+            const unsigned long long totalBefore = AllocationCounter::totalCount();
+            const unsigned long long threadBefore = AllocationCounter::threadCount();
+            samplerStopped = !smc.step();
+            workerAllocations = (AllocationCounter::totalCount() - totalBefore) -
+                                (AllocationCounter::threadCount() - threadBefore);
+            smc.writePosteriorMean(parameters);
+            currentTolerance = smc.getTolerance();
+            logFile << "  ABC-SMC generation " << smc.getGeneration() << ", tolerance " << currentTolerance
+                    << ", acceptance rate " << smc.getAcceptanceRate()
+                    << ", simulations " << smc.getSimulationCount() << '\n';
+        } else {
+            const unsigned long long threadBefore = AllocationCounter::threadCount();
+            abcMethod.refineParameters(parameters, skuData, normalizedFeatures, daysToSimulate, tolerance);
+            workerAllocations = abcMethod.getLastRefineAllocations() - (AllocationCounter::threadCount() - threadBefore);
+        }
 
-        std::vector<double> simulatedPrices = abcMethod.simulateFuturePrices(skuData, normalizedFeatures, daysToSimulate);
+        // Mismo camino que simulateFuturePrices, sobre el modelo y el buffer del motor
+        iterationModel.build(skuData, normalizedFeatures, parameters);
+        simulatedPrices.resize(iterationModel.empty() ? 0 : daysToSimulate);
+        RandomEngine pathEngine = abcMethod.nextSimulationEngine();
+        abcMethod.simulatePricePath(iterationModel, daysToSimulate, pathEngine, simulatedPrices.data());
 
         double distance = abcMethod.calculateDistance(simulatedPrices, skuData);
-        double saleValue = std::accumulate(simulatedPrices.begin(), simulatedPrices.end(), 0.0);
+        logFile << "  Distance: " << distance << '\n';
 
-        logFile << "  Distance: " << distance << std::endl;
+        // Una sola pasada por el camino: media, extremos y acumuladores por día
+        RunningStats pathSummary;
+        for (double price : simulatedPrices) {
+            pathSummary.add(price);
+        }
+        pathStatistics.addPath(simulatedPrices.data(), static_cast<int>(simulatedPrices.size()));
 
-        double averageSaleValue = saleValue / daysToSimulate;
-        double minSaleValue = *std::min_element(simulatedPrices.begin(), simulatedPrices.end());
-        double maxSaleValue = *std::max_element(simulatedPrices.begin(), simulatedPrices.end());
+        double averageSaleValue = pathSummary.mean();
+        double minSaleValue = pathSummary.min();
+        double maxSaleValue = pathSummary.max();
 
-        statsFile << i + 1 << "," << averageSaleValue << "," << minSaleValue << "," << maxSaleValue 
-                  << "," << distance << "," << tolerance;
-        for (const auto& param : parameters) {
-            statsFile << "," << param.probability;
+        std::chrono::duration<double> iterationTime = std::chrono::steady_clock::now() - iterationStart;
+        metrics.endIteration(i + 1, iterationTime.count(),
+                             sampler == SamplerType::SMC ? smc.getAcceptanceRate() : -1.0);
+
+        if (pathHistory) {
+            pathRow[0] = i + 1;
+            std::copy(simulatedPrices.begin(), simulatedPrices.end(), pathRow.begin() + 1);
+            pathHistory->writeRow(pathRow);
         }
-        statsFile << std::endl;
 
         if (distance < bestDistance) {
             bestDistance = distance;
-            bestSimulation = simulatedPrices;
-            logFile << "  New best simulation found" << std::endl;
-            std::cout << "  New best simulation found" << std::endl;
+            bestSimulation.assign(simulatedPrices.begin(), simulatedPrices.end());
+            logFile << "  New best simulation found\n";
+            LOG_DEBUG("  New best simulation found");
         }
 
-        allSimulatedPrices.push_back(simulatedPrices);
-
-        logFile << "  Current parameters:" << std::endl;
+        logFile << "  Current parameters:\n";
         for (const auto& param : parameters) {
-            logFile << "    " << param.name << ": " << param.probability << std::endl;
+            logFile << "    " << param.name << ": " << param.probability << '\n';
         }
 
-        logFile << "  Simulation summary:" << std::endl;
-        logFile << "    Average price: " << averageSaleValue << std::endl;
-        logFile << "    Min price: " << minSaleValue << std::endl;
-        logFile << "    Max price: " << maxSaleValue << std::endl;
+        logFile << "  Simulation summary:\n";
+        logFile << "    Average price: " << averageSaleValue << '\n';
+        logFile << "    Min price: " << minSaleValue << '\n';
+        logFile << "    Max price: " << maxSaleValue << '\n';
+
+        // La fila se escribe al final para que Allocations cubra toda la iteración
+        statsRow[0] = i + 1;
+        statsRow[1] = averageSaleValue;
+        statsRow[2] = minSaleValue;
+        statsRow[3] = maxSaleValue;
+        statsRow[4] = distance;
+        statsRow[5] = currentTolerance;
+        statsRow[6] = AllocationCounter::ENABLED
+                          ? static_cast<double>(AllocationCounter::threadCount() - allocationsBefore + workerAllocations)
+                          : std::numeric_limits<double>::quiet_NaN();
+        for (size_t p = 0; p < parameters.size(); ++p) {
+            statsRow[parameterColumn + p] = parameters[p].probability;
+        }
+        const PosteriorSummary& posterior =
+            sampler == SamplerType::SMC ? smc.getPosteriorSummary() : abcMethod.getLastSummary();
+        const size_t posteriorColumn = parameterColumn + parameters.size();
+        statsRow[posteriorColumn] = posterior.effectiveSampleSize;
+        for (size_t p = 0; p < parameters.size(); ++p) {
+            const bool known = p < posterior.lower.size();
+            statsRow[posteriorColumn + 1 + 2 * p] = known ? posterior.lower[p] : std::numeric_limits<double>::quiet_NaN();
+            statsRow[posteriorColumn + 2 + 2 * p] = known ? posterior.upper[p] : std::numeric_limits<double>::quiet_NaN();
+        }
+        statsFile.writeRow(statsRow);
+        completedIterations = i + 1;
+        finalTolerance = currentTolerance;
 
-        if (distance <= tolerance) {
-            logFile << "Satisfactory simulation found. Stopping early." << std::endl;
+        if (sampler == SamplerType::SMC) {
+            if (smc.getStopReason() == SMCStopReason::AcceptanceCollapsed) {
+                logFile << "ABC-SMC acceptance rate collapsed at generation " << smc.getGeneration()
+                        << " before reaching tolerance " << tolerance << ". Stopping without convergence.\n";
+                break;
+            }
+            if (samplerStopped || smc.hasConverged()) {
+                logFile << "ABC-SMC converged at generation " << smc.getGeneration() << ". Stopping early.\n";
+                break;
+            }
+        } else if (distance <= tolerance) {
+            logFile << "Satisfactory simulation found. Stopping early.\n";
             break;
         }
     }
 
-    logFile << "\nFinal Results:" << std::endl;
-    logFile << "Best simulation distance: " << bestDistance << std::endl;
-    logFile << "Best simulation prices:" << std::endl;
+    logFile << "\nFinal Results:\n";
+    logFile << "Best simulation distance: " << bestDistance << '\n';
+    logFile << "Best simulation prices:\n";
     for (size_t i = 0; i < bestSimulation.size(); ++i) {
-        logFile << "  Day " << i + 1 << ": " << bestSimulation[i] << std::endl;
+        logFile << "  Day " << i + 1 << ": " << bestSimulation[i] << '\n';
     }
 
-    std::vector<double> averagePrices(daysToSimulate, 0.0);
-    for (const auto& simulation : allSimulatedPrices) {
-        for (size_t i = 0; i < simulation.size(); ++i) {
-            averagePrices[i] += simulation[i];
+    logFile << "\nAverage prices across all simulations:\n";
+    for (int d = 0; d < pathStatistics.days(); ++d) {
+        logFile << "  Day " << d + 1 << ": " << pathStatistics.day(d).mean() << '\n';
+    }
+
+    logFile << "\nPrice distribution across all simulations (standard deviation, 5%, 50% and 95% quantiles):\n";
+    for (int d = 0; d < pathStatistics.days(); ++d) {
+        logFile << "  Day " << d + 1 << ": " << pathStatistics.day(d).standardDeviation();
+        for (size_t k = 0; k < pathStatistics.getQuantiles().size(); ++k) {
+            logFile << ", " << pathStatistics.quantile(d, static_cast<int>(k));
         }
+        logFile << '\n';
     }
-    for (auto& price : averagePrices) {
-        price /= allSimulatedPrices.size();
+
+    logFile << "\nFinal parameters:\n";
+    for (const auto& param : parameters) {
+        logFile << "  " << param.name << ": " << param.probability << '\n';
     }
 
-    logFile << "\nAverage prices across all simulations:" << std::endl;
-    for (size_t i = 0; i < averagePrices.size(); ++i) {
-        logFile << "  Day " << i + 1 << ": " << averagePrices[i] << std::endl;
+    logFile.close();
+    statsFile.flush();
+    if (pathHistory) {
+        pathHistory->flush();
     }
 
-    logFile << "\nFinal parameters:" << std::endl;
-    for (const auto& param : parameters) {
-        logFile << "  " << param.name << ": " << param.probability << std::endl;
+    LOG_INFO("Simulation completed. Results saved in " << logPath << " and " << statsPath);
+
+    if (!checkpointPath.empty()) {
+        saveRunCheckpoint(contentHash, completedIterations, finalTolerance, smc);
+    }
+
+    if (metrics.isEnabled()) {
+        std::chrono::duration<double> wallTime = std::chrono::steady_clock::now() - runStart;
+        const char* samplerName = sampler == SamplerType::SMC ? "smc" : "rejection";
+        if (metrics.writeReport(metricsPath, skuData.sku, samplerName, wallTime.count())) {
+            LOG_INFO("Metrics report saved in " << metricsPath);
+        } else {
+            LOG_WARNING("Could not write metrics report " << metricsPath);
+        }
+    }
+    return true;
+}
+
+bool SimulationEngine::applyCheckpoint(const PosteriorCheckpoint& checkpoint) {
+    bool sameParameters = checkpoint.parameterNames.size() == parameters.size();
+    for (size_t p = 0; p < parameters.size(); ++p) {
+        if (sameParameters && checkpoint.parameterNames[p] == parameters[p].name) {
+            parameters[p].probability = checkpoint.probabilities[p];
+            continue;
+        }
+        sameParameters = false;
+        auto name = std::find(checkpoint.parameterNames.begin(), checkpoint.parameterNames.end(), parameters[p].name);
+        if (name != checkpoint.parameterNames.end()) {
+            parameters[p].probability = checkpoint.probabilities[name - checkpoint.parameterNames.begin()];
+        }
+    }
+    return sameParameters;
+}
+
+bool SimulationEngine::writeSkippedLog(const PosteriorCheckpoint& checkpoint) {
+    SinkStream logFile(openOutput(logPath, logBuffer));
+    if (!logFile.isOpen()) {
+        LOG_ERROR("Error: Could not open output file for writing (" << logPath << ")");
+        return false;
     }
 
+    logFile << "Inputs unchanged since checkpoint " << checkpointPath << ", calibration skipped\n";
+    logFile << "Checkpoint tolerance: " << checkpoint.tolerance << " after " << checkpoint.iterations << " iterations\n";
+    logFile << "\nFinal parameters:\n";
+    for (const auto& param : parameters) {
+        logFile << "  " << param.name << ": " << param.probability << '\n';
+    }
     logFile.close();
-    statsFile.close();
+    return true;
+}
 
-    std::cout << "Simulation completed. Results saved in simulation_log.txt and statistics_simulations.txt" << std::endl;
-}
\ No newline at end of file
+void SimulationEngine::saveRunCheckpoint(std::uint64_t contentHash, int iterations, double tolerance, const ABCSMC& smc) {
+    PosteriorCheckpoint checkpoint;
+    checkpoint.sku = skuData.sku;
+    checkpoint.contentHash = contentHash;
+    checkpoint.sampler = sampler;
+    checkpoint.iterations = iterations;
+    checkpoint.tolerance = tolerance;
+    for (const auto& param : parameters) {
+        checkpoint.parameterNames.push_back(param.name);
+        checkpoint.probabilities.push_back(param.probability);
+    }
+
+    ParticlePopulation& particles = checkpoint.particles;
+    if (sampler == SamplerType::SMC) {
+        particles = smc.getPopulation();
+    } else {
+        particles.dimension = static_cast<int>(parameters.size());
+        int count = abcMethod.getLastAccepted(particles.values, particles.distances);
+        particles.weights.assign(count, count > 0 ? 1.0 / count : 0.0);
+        particles.tolerance = tolerance;
+    }
+
+    if (saveCheckpoint(checkpointPath, checkpoint)) {
+        LOG_INFO("Checkpoint saved in " << checkpointPath);
+    }
+}
@@ -0,0 +1,316 @@
+#include "../include/Snapshot.h"
+#include "../include/Logger.h"
+#include "../include/BatchRunner.h"
+#include "../include/DataLoader.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <set>
+
+namespace {
+
+const char SNAPSHOT_MAGIC[8] = {'A', 'B', 'C', 'S', 'N', 'A', 'P', '\0'};
+const std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+std::uint64_t alignUp(std::uint64_t value) {
+    return (value + SNAPSHOT_ALIGNMENT - 1) / SNAPSHOT_ALIGNMENT * SNAPSHOT_ALIGNMENT;
+}
+
+void writePadding(std::ofstream& out, std::uint64_t& position, std::uint64_t target) {
+    static const char zeros[SNAPSHOT_ALIGNMENT] = {};
+    while (position < target) {
+        std::uint64_t chunk = std::min<std::uint64_t>(target - position, SNAPSHOT_ALIGNMENT);
+        out.write(zeros, static_cast<std::streamsize>(chunk));
+        position += chunk;
+    }
+}
+
+template <typename T>
+void writeArray(std::ofstream& out, std::uint64_t& position, const std::vector<T>& values) {
+    if (!values.empty()) {
+        out.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(T)));
+        position += values.size() * sizeof(T);
+    }
+}
+
+bool sectionFits(std::uint64_t offset, std::uint64_t count, std::uint64_t elementSize, std::uint64_t fileSize) {
+    return offset % SNAPSHOT_ALIGNMENT == 0 && offset <= fileSize &&
+           (elementSize == 0 || count <= (fileSize - offset) / elementSize);
+}
+
+} // namespace
+
+SnapshotReader::SnapshotReader()
+    : header(nullptr), records(nullptr), intervals(nullptr), featureNames(nullptr), featureValues(nullptr), strings(nullptr) {}
+
+bool SnapshotReader::open(const std::string& filename) {
+    header = nullptr;
+
+    if (!file.open(filename)) {
+        LOG_ERROR("Error: Could not open file " << filename);
+        return false;
+    }
+
+    if (file.size() < sizeof(SnapshotHeader)) {
+        LOG_ERROR("Error: " << filename << " is not a snapshot");
+        return false;
+    }
+
+    const SnapshotHeader* candidate = reinterpret_cast<const SnapshotHeader*>(file.data());
+    if (std::memcmp(candidate->magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0) {
+        LOG_ERROR("Error: " << filename << " is not a snapshot");
+        return false;
+    }
+    if (candidate->version != SNAPSHOT_VERSION || candidate->byteOrder != BYTE_ORDER_MARK) {
+        LOG_ERROR("Error: unsupported snapshot version or byte order in " << filename);
+        return false;
+    }
+
+    const std::uint64_t fileSize = file.size();
+    if (candidate->fileSize != fileSize ||
+        !sectionFits(candidate->skuRecordsOffset, candidate->skuCount, sizeof(SnapshotSKURecord), fileSize) ||
+        !sectionFits(candidate->intervalsOffset, candidate->intervalCount, sizeof(SnapshotInterval), fileSize) ||
+        !sectionFits(candidate->featureNamesOffset, candidate->featureCount, sizeof(SnapshotString), fileSize) ||
+        !sectionFits(candidate->featureValuesOffset,
+                     candidate->featureCount == 0 ? 0 : candidate->skuCount,
+                     candidate->featureCount * sizeof(double), fileSize) ||
+        !sectionFits(candidate->stringsOffset, candidate->stringsSize, 1, fileSize)) {
+        LOG_ERROR("Error: corrupted snapshot " << filename);
+        return false;
+    }
+
+    header = candidate;
+    records = reinterpret_cast<const SnapshotSKURecord*>(file.data() + header->skuRecordsOffset);
+    intervals = reinterpret_cast<const SnapshotInterval*>(file.data() + header->intervalsOffset);
+    featureNames = reinterpret_cast<const SnapshotString*>(file.data() + header->featureNamesOffset);
+    featureValues = reinterpret_cast<const double*>(file.data() + header->featureValuesOffset);
+    strings = file.data() + header->stringsOffset;
+
+    // Comprobar que cada registro apunta dentro de sus secciones
+    for (size_t i = 0; i < size(); ++i) {
+        const SnapshotSKURecord& record = records[i];
+        if (record.firstInterval > header->intervalCount ||
+            record.intervalCount > header->intervalCount - record.firstInterval ||
+            record.id.offset > header->stringsSize || record.id.length > header->stringsSize - record.id.offset) {
+            LOG_ERROR("Error: corrupted snapshot " << filename);
+            header = nullptr;
+            return false;
+        }
+    }
+    for (size_t i = 0; i < featureCount(); ++i) {
+        if (featureNames[i].offset > header->stringsSize ||
+            featureNames[i].length > header->stringsSize - featureNames[i].offset) {
+            LOG_ERROR("Error: corrupted snapshot " << filename);
+            header = nullptr;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+const char* SnapshotReader::stringAt(const SnapshotString& value) const {
+    return strings + value.offset;
+}
+
+std::string SnapshotReader::featureName(size_t index) const {
+    return std::string(stringAt(featureNames[index]), static_cast<size_t>(featureNames[index].length));
+}
+
+SnapshotSKUView SnapshotReader::view(size_t index) const {
+    const SnapshotSKURecord& record = records[index];
+    SnapshotSKUView result;
+    result.id = stringAt(record.id);
+    result.idLength = static_cast<size_t>(record.id.length);
+    result.intervals = intervals + record.firstInterval;
+    result.intervalCount = static_cast<size_t>(record.intervalCount);
+    result.globalMinPrice = record.globalMinPrice;
+    result.globalMaxPrice = record.globalMaxPrice;
+    result.featureValues = featureValues + index * featureCount();
+    return result;
+}
+
+bool SnapshotReader::find(const std::string& sku, size_t& index) const {
+    size_t low = 0;
+    size_t high = size();
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        const SnapshotSKURecord& record = records[middle];
+        int comparison = sku.compare(0, std::string::npos, stringAt(record.id), static_cast<size_t>(record.id.length));
+        if (comparison == 0) {
+            index = middle;
+            return true;
+        }
+        if (comparison > 0) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return false;
+}
+
+SKUData SnapshotReader::loadSKUData(size_t index) const {
+    SnapshotSKUView skuView = view(index);
+    SKUData data;
+    data.sku = skuView.sku();
+    data.globalMinPrice = skuView.globalMinPrice;
+    data.globalMaxPrice = skuView.globalMaxPrice;
+    data.listProducts.reserve(skuView.intervalCount);
+    data.intervals.reserve(skuView.intervalCount);
+    for (size_t i = 0; i < skuView.intervalCount; ++i) {
+        const SnapshotInterval& interval = skuView.intervals[i];
+        data.listProducts.push_back(std::make_pair(interval.minPrice, interval.maxPrice));
+        PriceInterval priceInterval = {interval.minPrice, interval.maxPrice, static_cast<int>(interval.count)};
+        data.intervals.push_back(priceInterval);
+    }
+    buildIntervalIndex(data);
+    return data;
+}
+
+std::map<std::string, double> SnapshotReader::loadNormalizedFeatures(size_t index) const {
+    std::map<std::string, double> features;
+    const double* values = view(index).featureValues;
+    for (size_t f = 0; f < featureCount(); ++f) {
+        if (!std::isnan(values[f])) {
+            features[featureName(f)] = values[f];
+        }
+    }
+    return features;
+}
+
+bool writeSnapshot(const std::string& filename, std::vector<SnapshotEntry> entries) {
+    std::sort(entries.begin(), entries.end(), [](const SnapshotEntry& a, const SnapshotEntry& b) {
+        return a.skuData.sku < b.skuData.sku;
+    });
+    for (size_t i = 1; i < entries.size(); ++i) {
+        if (entries[i].skuData.sku == entries[i - 1].skuData.sku) {
+            LOG_ERROR("Error: duplicated SKU " << entries[i].skuData.sku << " in snapshot");
+            return false;
+        }
+    }
+
+    // Tabla de nombres de features común a todos los SKU
+    std::set<std::string> nameSet;
+    for (const auto& entry : entries) {
+        for (const auto& feature : entry.normalizedFeatures) {
+            nameSet.insert(feature.first);
+        }
+    }
+    std::vector<std::string> names(nameSet.begin(), nameSet.end());
+
+    std::string stringData;
+    std::vector<SnapshotString> featureNames;
+    for (const auto& name : names) {
+        SnapshotString value = {stringData.size(), name.size()};
+        featureNames.push_back(value);
+        stringData += name;
+    }
+
+    std::vector<SnapshotSKURecord> records;
+    std::vector<SnapshotInterval> intervals;
+    std::vector<double> featureValues;
+    records.reserve(entries.size());
+    featureValues.reserve(entries.size() * names.size());
+
+    for (const auto& entry : entries) {
+        const SKUData& data = entry.skuData;
+        SnapshotSKURecord record;
+        record.id.offset = stringData.size();
+        record.id.length = data.sku.size();
+        stringData += data.sku;
+        record.firstInterval = intervals.size();
+        record.globalMinPrice = data.globalMinPrice;
+        record.globalMaxPrice = data.globalMaxPrice;
+
+        // Se guardan los tramos de list_products con su frecuencia si está disponible
+        for (size_t i = 0; i < data.listProducts.size(); ++i) {
+            SnapshotInterval interval;
+            interval.minPrice = data.listProducts[i].first;
+            interval.maxPrice = data.listProducts[i].second;
+            interval.count = i < data.intervals.size() ? data.intervals[i].count : 0;
+            intervals.push_back(interval);
+        }
+        record.intervalCount = intervals.size() - record.firstInterval;
+        records.push_back(record);
+
+        for (const auto& name : names) {
+            auto feature = entry.normalizedFeatures.find(name);
+            featureValues.push_back(feature == entry.normalizedFeatures.end()
+                                        ? std::numeric_limits<double>::quiet_NaN()
+                                        : feature->second);
+        }
+    }
+
+    SnapshotHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    header.version = SNAPSHOT_VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.skuCount = records.size();
+    header.intervalCount = intervals.size();
+    header.featureCount = names.size();
+    header.skuRecordsOffset = alignUp(sizeof(SnapshotHeader));
+    header.intervalsOffset = alignUp(header.skuRecordsOffset + records.size() * sizeof(SnapshotSKURecord));
+    header.featureNamesOffset = alignUp(header.intervalsOffset + intervals.size() * sizeof(SnapshotInterval));
+    header.featureValuesOffset = alignUp(header.featureNamesOffset + featureNames.size() * sizeof(SnapshotString));
+    header.stringsOffset = alignUp(header.featureValuesOffset + featureValues.size() * sizeof(double));
+    header.stringsSize = stringData.size();
+    header.fileSize = alignUp(header.stringsOffset + stringData.size());
+
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        LOG_ERROR("Error: Could not open file " << filename << " for writing");
+        return false;
+    }
+
+    std::uint64_t position = 0;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    position += sizeof(header);
+    writePadding(out, position, header.skuRecordsOffset);
+    writeArray(out, position, records);
+    writePadding(out, position, header.intervalsOffset);
+    writeArray(out, position, intervals);
+    writePadding(out, position, header.featureNamesOffset);
+    writeArray(out, position, featureNames);
+    writePadding(out, position, header.featureValuesOffset);
+    writeArray(out, position, featureValues);
+    writePadding(out, position, header.stringsOffset);
+    out.write(stringData.data(), static_cast<std::streamsize>(stringData.size()));
+    position += stringData.size();
+    writePadding(out, position, header.fileSize);
+
+    if (!out) {
+        LOG_ERROR("Error: failed writing snapshot " << filename);
+        return false;
+    }
+    return true;
+}
+
+size_t convertToSnapshot(const std::vector<SKUJob>& jobs, const std::string& filename) {
+    std::vector<SnapshotEntry> entries;
+    entries.reserve(jobs.size());
+    SKUIntervalCache intervalCache;
+
+    for (const auto& job : jobs) {
+        SnapshotEntry entry;
+        entry.skuData = intervalCache.load(job);
+        if (entry.skuData.listProducts.empty()) {
+            LOG_WARNING("Skipping SKU " << job.sku << ": no price intervals");
+            continue;
+        }
+        if (entry.skuData.sku.empty()) {
+            entry.skuData.sku = job.sku;
+        }
+        entry.normalizedFeatures = ::loadNormalizedFeatures(job.featuresPath);
+        entries.push_back(std::move(entry));
+    }
+
+    size_t count = entries.size();
+    if (!writeSnapshot(filename, std::move(entries))) {
+        return 0;
+    }
+    return count;
+}
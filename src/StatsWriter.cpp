@@ -0,0 +1,68 @@
+#include "../include/StatsWriter.h"
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+
+bool parseStatsFormat(const std::string& value, StatsFormat& format) {
+    if (value == "csv") {
+        format = StatsFormat::CSV;
+    } else if (value == "binary") {
+        format = StatsFormat::Binary;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+StatsWriter::StatsWriter(std::unique_ptr<OutputSink> sink, StatsFormat format)
+    : sink(std::move(sink)), format(format) {}
+
+void StatsWriter::writeHeader(const std::vector<std::string>& columns) {
+    if (format == StatsFormat::Binary) {
+        const char magic[8] = {'A', 'B', 'C', 'S', 'T', 'A', 'T', '1'};
+        sink->write(magic, sizeof(magic));
+        std::uint32_t count = static_cast<std::uint32_t>(columns.size());
+        sink->write(reinterpret_cast<const char*>(&count), sizeof(count));
+        for (const auto& column : columns) {
+            std::uint32_t length = static_cast<std::uint32_t>(column.size());
+            sink->write(reinterpret_cast<const char*>(&length), sizeof(length));
+            sink->write(column.data(), column.size());
+        }
+        return;
+    }
+
+    line.clear();
+    for (size_t i = 0; i < columns.size(); ++i) {
+        if (i > 0) {
+            line += ',';
+        }
+        line += columns[i];
+    }
+    line += '\n';
+    sink->write(line.data(), line.size());
+}
+
+void StatsWriter::writeRow(const std::vector<double>& values) {
+    if (format == StatsFormat::Binary) {
+        sink->write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(double));
+        return;
+    }
+
+    line.clear();
+    char number[32];
+    for (size_t i = 0; i < values.size(); ++i) {
+        // Los enteros (p. ej. el número de iteración) se escriben completos
+        bool integral = std::fabs(values[i]) < 1e15 && values[i] == std::floor(values[i]);
+        int length = std::snprintf(number, sizeof(number), integral ? "%.0f" : "%g", values[i]);
+        if (i > 0) {
+            line += ',';
+        }
+        line.append(number, static_cast<size_t>(length));
+    }
+    line += '\n';
+    sink->write(line.data(), line.size());
+}
+
+void StatsWriter::flush() {
+    sink->flush();
+}
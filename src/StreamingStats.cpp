@@ -0,0 +1,148 @@
+#include "../include/StreamingStats.h"
+#include <algorithm>
+#include <cmath>
+
+RunningStats::RunningStats() {
+    clear();
+}
+
+void RunningStats::clear() {
+    n = 0;
+    runningMean = 0.0;
+    squaredDeviations = 0.0;
+    minimum = 0.0;
+    maximum = 0.0;
+}
+
+double RunningStats::standardDeviation() const {
+    return std::sqrt(variance());
+}
+
+P2Quantile::P2Quantile(double quantile) : q(std::max(0.0, std::min(1.0, quantile))), n(0) {
+    for (int i = 0; i < 5; ++i) {
+        heights[i] = 0.0;
+        positions[i] = i + 1;
+    }
+    desired[0] = 1.0;
+    desired[1] = 1.0 + 2.0 * q;
+    desired[2] = 1.0 + 4.0 * q;
+    desired[3] = 3.0 + 2.0 * q;
+    desired[4] = 5.0;
+    increments[0] = 0.0;
+    increments[1] = q / 2.0;
+    increments[2] = q;
+    increments[3] = (1.0 + q) / 2.0;
+    increments[4] = 1.0;
+}
+
+void P2Quantile::add(double value) {
+    // Las cinco primeras observaciones son las alturas iniciales de los marcadores
+    if (n < 5) {
+        heights[n++] = value;
+        if (n == 5) {
+            std::sort(heights, heights + 5);
+        }
+        return;
+    }
+    ++n;
+
+    // Celda k del valor; los extremos se amplían si el valor cae fuera
+    int k;
+    if (value < heights[0]) {
+        heights[0] = value;
+        k = 0;
+    } else if (value >= heights[4]) {
+        heights[4] = std::max(heights[4], value);
+        k = 3;
+    } else {
+        k = 0;
+        while (k < 3 && value >= heights[k + 1]) {
+            ++k;
+        }
+    }
+
+    for (int i = k + 1; i < 5; ++i) {
+        positions[i] += 1.0;
+    }
+    for (int i = 0; i < 5; ++i) {
+        desired[i] += increments[i];
+    }
+
+    // Los marcadores interiores se mueven una posición hacia su posición deseada
+    for (int i = 1; i < 4; ++i) {
+        const double offset = desired[i] - positions[i];
+        if ((offset >= 1.0 && positions[i + 1] - positions[i] > 1.0) ||
+            (offset <= -1.0 && positions[i - 1] - positions[i] < -1.0)) {
+            const int direction = offset > 0.0 ? 1 : -1;
+            const double candidate = parabolic(i, direction);
+            heights[i] = heights[i - 1] < candidate && candidate < heights[i + 1] ? candidate : linear(i, direction);
+            positions[i] += direction;
+        }
+    }
+}
+
+double P2Quantile::value() const {
+    if (n == 0) {
+        return 0.0;
+    }
+    if (n >= 5) {
+        return heights[2];
+    }
+
+    // Pocos valores (n < 5): cuantil exacto con interpolación lineal entre los ordenados.
+    // Ordenación por inserción con el tamaño acotado explícitamente a 5.
+    const int count = static_cast<int>(n);
+    double sorted[5];
+    for (int i = 0; i < count && i < 5; ++i) {
+        const double value = heights[i];
+        int j = i;
+        for (; j > 0 && sorted[j - 1] > value; --j) {
+            sorted[j] = sorted[j - 1];
+        }
+        sorted[j] = value;
+    }
+    const double rank = q * (count - 1);
+    const int below = static_cast<int>(rank);
+    const int above = std::min(below + 1, count - 1);
+    return sorted[below] + (rank - below) * (sorted[above] - sorted[below]);
+}
+
+double P2Quantile::parabolic(int i, double direction) const {
+    return heights[i] + direction / (positions[i + 1] - positions[i - 1]) *
+                            ((positions[i] - positions[i - 1] + direction) * (heights[i + 1] - heights[i]) /
+                                 (positions[i + 1] - positions[i]) +
+                             (positions[i + 1] - positions[i] - direction) * (heights[i] - heights[i - 1]) /
+                                 (positions[i] - positions[i - 1]));
+}
+
+double P2Quantile::linear(int i, int direction) const {
+    return heights[i] + direction * (heights[i + direction] - heights[i]) / (positions[i + direction] - positions[i]);
+}
+
+PathStatistics::PathStatistics() : paths(0) {}
+
+void PathStatistics::reset(int days, const std::vector<double>& quantiles) {
+    this->quantiles = quantiles;
+    this->paths = 0;
+    dayStats.assign(std::max(0, days), RunningStats());
+    sketches.clear();
+    sketches.reserve(dayStats.size() * quantiles.size());
+    for (size_t d = 0; d < dayStats.size(); ++d) {
+        for (double quantile : quantiles) {
+            sketches.push_back(P2Quantile(quantile));
+        }
+    }
+}
+
+void PathStatistics::addPath(const double* prices, int count) {
+    const int n = std::min(count, days());
+    const size_t quantileCount = quantiles.size();
+    for (int d = 0; d < n; ++d) {
+        dayStats[d].add(prices[d]);
+        P2Quantile* daySketches = sketches.data() + static_cast<size_t>(d) * quantileCount;
+        for (size_t k = 0; k < quantileCount; ++k) {
+            daySketches[k].add(prices[d]);
+        }
+    }
+    ++paths;
+}
@@ -0,0 +1,108 @@
+#include "../include/ThreadPool.h"
+#include <algorithm>
+
+namespace {
+
+// Índice del hilo del pool que ejecuta el código actual (-1 fuera del pool)
+thread_local int currentWorker = -1;
+thread_local const ThreadPool* currentPool = nullptr;
+
+} // namespace
+
+ThreadPool::ThreadPool(int threads)
+    : pendingTasks(0), queuedTasks(0), stealCount(0), nextQueue(0), stopping(false) {
+    if (threads <= 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (int i = 0; i < threads; ++i) {
+        queues.push_back(std::unique_ptr<WorkQueue>(new WorkQueue()));
+    }
+    for (int i = 0; i < threads; ++i) {
+        workers.push_back(std::thread(&ThreadPool::workerLoop, this, i));
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    int index = (currentPool == this && currentWorker >= 0)
+                    ? currentWorker
+                    : static_cast<int>(nextQueue.fetch_add(1) % queues.size());
+
+    pendingTasks.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lock(queues[index]->mutex);
+        queues[index]->tasks.push_back(std::move(task));
+    }
+    {
+        // El contador se actualiza bajo stateMutex para que ningún hilo se duerma con trabajo pendiente
+        std::lock_guard<std::mutex> lock(stateMutex);
+        queuedTasks.fetch_add(1);
+    }
+    workAvailable.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(stateMutex);
+    allDone.wait(lock, [this]() { return pendingTasks.load() == 0; });
+}
+
+bool ThreadPool::popLocal(int index, std::function<void()>& task) {
+    std::lock_guard<std::mutex> lock(queues[index]->mutex);
+    if (queues[index]->tasks.empty()) {
+        return false;
+    }
+    task = std::move(queues[index]->tasks.back());
+    queues[index]->tasks.pop_back();
+    return true;
+}
+
+bool ThreadPool::steal(int index, std::function<void()>& task) {
+    const int count = static_cast<int>(queues.size());
+    for (int offset = 1; offset < count; ++offset) {
+        WorkQueue& victim = *queues[(index + offset) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            stealCount.fetch_add(1);
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(int index) {
+    currentWorker = index;
+    currentPool = this;
+
+    while (true) {
+        std::function<void()> task;
+        if (popLocal(index, task) || steal(index, task)) {
+            queuedTasks.fetch_sub(1);
+            task();
+            if (pendingTasks.fetch_sub(1) == 1) {
+                std::lock_guard<std::mutex> lock(stateMutex);
+                allDone.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(stateMutex);
+        workAvailable.wait(lock, [this]() { return stopping || queuedTasks.load() > 0; });
+        if (stopping && queuedTasks.load() == 0) {
+            return;
+        }
+    }
+}
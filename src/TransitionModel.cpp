@@ -0,0 +1,170 @@
+#include "../include/TransitionModel.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Peso de la distancia entre tramos: con 4 un salto de extremo a extremo es e^8 veces menos probable
+const double LOCALITY = 4.0;
+
+// Límites del coeficiente logit y de la deriva para evitar desbordes en exp()
+const double PROBABILITY_EPSILON = 1e-6;
+const double MAX_DRIFT = 20.0;
+
+double logit(double probability) {
+    probability = std::max(PROBABILITY_EPSILON, std::min(1.0 - PROBABILITY_EPSILON, probability));
+    return std::log(probability / (1.0 - probability));
+}
+
+} // namespace
+
+void FeatureBinding::bind(const ParameterSet& parameters, const std::map<std::string, double>& normalizedFeatures) {
+    parameterIndex.clear();
+    values.clear();
+    for (int i = 0; i < parameters.size(); ++i) {
+        auto feature = normalizedFeatures.find(parameters.name(i));
+        if (feature != normalizedFeatures.end()) {
+            parameterIndex.push_back(i);
+            values.push_back(feature->second);
+        }
+    }
+}
+
+TransitionModel::TransitionModel() : intervalCount(0), drift(0.0) {}
+
+void TransitionModel::build(const SKUData& skuData,
+                            const std::map<std::string, double>& normalizedFeatures,
+                            const std::vector<Parameter>& parameters) {
+    parameterScratch.assign(parameters);
+    bindingScratch.bind(parameterScratch, normalizedFeatures);
+    build(skuData, bindingScratch, parameterScratch.probabilities());
+}
+
+void TransitionModel::build(const SKUData& skuData, const FeatureBinding& features, const double* probabilities) {
+    const int n = static_cast<int>(skuData.listProducts.size());
+    intervalCount = n;
+    if (n == 0) {
+        return;
+    }
+
+    // Deriva: media de las features ponderadas por logit(probability) del parámetro homónimo
+    drift = 0.0;
+    for (int k = 0; k < features.size(); ++k) {
+        drift += logit(probabilities[features.parameterIndex[k]]) * features.values[k];
+    }
+    drift = features.size() > 0 ? drift / features.size() : 0.0;
+    drift = std::max(-MAX_DRIFT, std::min(MAX_DRIFT, drift));
+
+    // Posición de cada tramo en [-1, 1] según su punto medio
+    lowers.resize(n);
+    widths.resize(n);
+    positions.resize(n);
+    double minMid = skuData.listProducts[0].first;
+    double maxMid = minMid;
+    for (int j = 0; j < n; ++j) {
+        lowers[j] = skuData.listProducts[j].first;
+        widths[j] = skuData.listProducts[j].second - skuData.listProducts[j].first;
+        positions[j] = lowers[j] + 0.5 * widths[j];
+        minMid = std::min(minMid, positions[j]);
+        maxMid = std::max(maxMid, positions[j]);
+    }
+    const double span = maxMid - minMid;
+    for (int j = 0; j < n; ++j) {
+        positions[j] = span > 0.0 ? 2.0 * (positions[j] - minMid) / span - 1.0 : 0.0;
+    }
+
+    const size_t cells = static_cast<size_t>(n + 1) * n;
+    acceptance.resize(cells);
+    aliases.resize(cells);
+    rowTotals.resize(n + 1);
+    weights.resize(n);
+    scaled.resize(n);
+    // Las pilas de Vose nunca superan n elementos: reservarlas evita crecer a mitad de una fila
+    small.reserve(n);
+    large.reserve(n);
+
+    // exp(-locality * |z_j - z_i|) se separa en factores por tramo según el signo de z_j - z_i,
+    // así la matriz completa necesita 3n exponenciales en lugar de n². La deriva se desplaza
+    // por su máximo antes de exp() (softmax estable).
+    double maxDrift = -HUGE_VAL;
+    for (int j = 0; j < n; ++j) {
+        maxDrift = std::max(maxDrift, drift * positions[j]);
+    }
+    driftWeights.resize(n);
+    ups.resize(n);
+    downs.resize(n);
+    for (int j = 0; j < n; ++j) {
+        driftWeights[j] = std::exp(drift * positions[j] - maxDrift);
+        ups[j] = std::exp(LOCALITY * positions[j]);
+        downs[j] = std::exp(-LOCALITY * positions[j]);
+    }
+
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) {
+            weights[j] = weight(i, j);
+        }
+        buildRow(i, weights.data());
+    }
+    buildRow(n, driftWeights.data());
+}
+
+double TransitionModel::probability(int from, int to) const {
+    if (from < 0 || from >= intervalCount || to < 0 || to >= intervalCount) {
+        return 0.0;
+    }
+    return weight(from, to) / rowTotals[from];
+}
+
+double TransitionModel::weight(int from, int to) const {
+    const double locality = positions[to] >= positions[from] ? downs[to] * ups[from] : ups[to] * downs[from];
+    return driftWeights[to] * locality;
+}
+
+void TransitionModel::buildRow(int row, const double* rowWeights) {
+    const int n = intervalCount;
+    const size_t offset = static_cast<size_t>(row) * n;
+    double* rowAcceptance = acceptance.data() + offset;
+    int* rowAliases = aliases.data() + offset;
+
+    double total = 0.0;
+    for (int j = 0; j < n; ++j) {
+        total += rowWeights[j];
+    }
+    rowTotals[row] = total;
+
+    // Vose: cada columna recibe masa media 1; las de menos de 1 se completan con una de más de 1
+    small.clear();
+    large.clear();
+    for (int j = 0; j < n; ++j) {
+        scaled[j] = rowWeights[j] * n / total;
+        rowAliases[j] = j;
+        if (scaled[j] < 1.0) {
+            small.push_back(j);
+        } else {
+            large.push_back(j);
+        }
+    }
+
+    while (!small.empty() && !large.empty()) {
+        const int less = small.back();
+        small.pop_back();
+        const int more = large.back();
+
+        rowAcceptance[less] = scaled[less];
+        rowAliases[less] = more;
+
+        scaled[more] = (scaled[more] + scaled[less]) - 1.0;
+        if (scaled[more] < 1.0) {
+            large.pop_back();
+            small.push_back(more);
+        }
+    }
+
+    // Restos por redondeo: masa 1 sin alias
+    for (int j : large) {
+        rowAcceptance[j] = 1.0;
+    }
+    for (int j : small) {
+        rowAcceptance[j] = 1.0;
+    }
+}
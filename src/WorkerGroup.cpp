@@ -0,0 +1,72 @@
+#include "../include/WorkerGroup.h"
+
+WorkerGroup::WorkerGroup()
+    : task(nullptr), context(nullptr), round(0), activeBlocks(0), pendingBlocks(0), stopping(false) {}
+
+WorkerGroup::~WorkerGroup() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    startRound.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void WorkerGroup::run(int blocks, void (*task)(void*, int), void* context) {
+    if (blocks <= 1) {
+        if (blocks == 1) {
+            task(context, 0);
+        }
+        return;
+    }
+
+    // El hilo i del grupo ejecuta el bloque i + 1
+    while (static_cast<int>(workers.size()) < blocks - 1) {
+        // Se crea con la ronda actual como ya vista: solo ejecutará la que se publica a continuación
+        workers.push_back(std::thread(&WorkerGroup::workerLoop, this, static_cast<int>(workers.size()) + 1, round));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->task = task;
+        this->context = context;
+        activeBlocks = blocks;
+        pendingBlocks = blocks - 1;
+        ++round;
+    }
+    startRound.notify_all();
+
+    task(context, 0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    roundDone.wait(lock, [this]() { return pendingBlocks == 0; });
+}
+
+void WorkerGroup::workerLoop(int block, unsigned long long seenRound) {
+    while (true) {
+        void (*currentTask)(void*, int);
+        void* currentContext;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            startRound.wait(lock, [this, seenRound]() { return stopping || round != seenRound; });
+            if (stopping) {
+                return;
+            }
+            seenRound = round;
+            if (block >= activeBlocks) {
+                continue;
+            }
+            currentTask = task;
+            currentContext = context;
+        }
+
+        currentTask(currentContext, block);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--pendingBlocks == 0) {
+            roundDone.notify_one();
+        }
+    }
+}
@@ -1,8 +1,10 @@
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <sstream>
 #include <vector>
 #include <chrono>
+#include <cstdlib>
 #include <string>
 #include <limits>
 #include <utility>
@@ -10,29 +12,297 @@
 #include "../include/Parameter.h"
 #include "../include/SimulationEngine.h"
 #include "../include/DataLoader.h"
+#include "../include/BatchRunner.h"
+#include "../include/ShardCoordinator.h"
+#include "../include/Logger.h"
+#include "../include/OutputSink.h"
+#include "../include/ScenarioQuery.h"
+
+namespace {
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [--config <file>] [--batch <manifest|directory>] [--workers <n>] [--output <directory>]\n"
+              << "       " << program << " [--config <file>] --snapshot <file> [--output <directory>]\n"
+              << "       " << program << " --batch <manifest|directory> --make-snapshot <file>\n"
+              << "       " << program << " [--config <file>] [--batch <manifest|directory> --sku <id>] --query <file|->" << std::endl;
+}
+
+void printBatchSummary(const BatchSummary& summary) {
+    std::cout << "\n*** Batch ***" << std::endl;
+    std::cout << "SKUs: " << summary.results.size() << " (" << summary.succeeded << " ok, " << summary.skipped << " of them unchanged, " << summary.failed << " failed)" << std::endl;
+    std::cout << "Time: " << summary.seconds << " seconds" << std::endl;
+    std::cout << "Throughput: " << summary.skusPerSecond << " SKUs/second" << std::endl;
+    std::cout << "Stolen tasks: " << summary.steals << std::endl;
+    if (summary.requeued > 0) {
+        std::cout << "Requeued SKUs: " << summary.requeued << std::endl;
+    }
+}
+
+int runBatch(const SimulationConfig& config, const std::string& batchPath, const std::string& outputDirectory) {
+    std::vector<SKUJob> jobs = loadSKUJobs(batchPath);
+    if (jobs.empty()) {
+        LOG_ERROR("No SKU jobs found in " << batchPath);
+        return 1;
+    }
+
+    BatchRunner runner(config, outputDirectory);
+    BatchSummary summary = config.pipeline ? runner.runPipelined(jobs) : runner.run(jobs);
+    printBatchSummary(summary);
+
+    return summary.failed == 0 ? 0 : 2;
+}
+
+// Cada trabajador vuelve a ejecutar este programa con la misma configuración
+int runShardedBatch(const SimulationConfig& config, const std::string& configPath, const std::string& batchPath,
+                    const std::string& outputDirectory, const char* program) {
+    std::vector<SKUJob> jobs = loadSKUJobs(batchPath);
+    if (jobs.empty()) {
+        LOG_ERROR("No SKU jobs found in " << batchPath);
+        return 1;
+    }
+
+    ShardSettings settings;
+    settings.workers = config.workerProcesses;
+    settings.maxAttempts = config.maxSKUAttempts;
+    ShardCoordinator coordinator({program, "--config", configPath}, outputDirectory, settings);
+    BatchSummary summary = coordinator.run(jobs);
+    printBatchSummary(summary);
+
+    return summary.failed == 0 ? 0 : 2;
+}
+
+int runSnapshotBatch(const SimulationConfig& config, const std::string& snapshotPath, const std::string& outputDirectory) {
+    SnapshotReader snapshot;
+    if (!snapshot.open(snapshotPath)) {
+        return 1;
+    }
+
+    BatchRunner runner(config, outputDirectory);
+    BatchSummary summary = runner.run(snapshot);
+    printBatchSummary(summary);
+
+    return summary.failed == 0 ? 0 : 2;
+}
+
+int makeSnapshot(const std::string& batchPath, const std::string& snapshotPath) {
+    std::vector<SKUJob> jobs = loadSKUJobs(batchPath);
+    if (jobs.empty()) {
+        LOG_ERROR("No SKU jobs found in " << batchPath);
+        return 1;
+    }
+
+    size_t written = convertToSnapshot(jobs, snapshotPath);
+    std::cout << "Snapshot " << snapshotPath << " written with " << written << " SKUs" << std::endl;
+    return written > 0 ? 0 : 1;
+}
+
+// Misma configuración del motor en el modo de un SKU y en el de consultas
+void configureEngine(SimulationEngine& simulationEngine, const SimulationConfig& config, const SKUData& skuData,
+                     const std::map<std::string, double>& normalizedFeatures, const std::string& outputDirectory,
+                     double loadSeconds) {
+    simulationEngine.setProductData(skuData);
+    simulationEngine.setNormalizedFeatures(normalizedFeatures);
+    simulationEngine.setNumberOfThreads(config.numberOfThreads);
+    simulationEngine.setNumberOfSimulations(config.numberOfSimulations);
+    simulationEngine.setSampler(config.sampler);
+    simulationEngine.setDistanceMetric(config.distanceMetric);
+    simulationEngine.setRegressionAdjustment(config.regressionAdjustment);
+    simulationEngine.setSMCSettings(config.smc);
+    if (config.hasSeed) {
+        simulationEngine.setSeed(config.seed);
+    }
+    simulationEngine.setOutputPaths(outputDirectory + "/simulation_log.txt",
+                                    outputDirectory + "/statistics_simulations.txt");
+    simulationEngine.setOutputOptions(config.statsFormat, config.asyncOutput);
+    if (config.pathHistory) {
+        simulationEngine.setPathHistoryPath(outputDirectory + "/simulated_paths.txt");
+    }
+    if (config.metrics) {
+        simulationEngine.setMetricsPath(config.metricsFile.empty() ? outputDirectory + "/metrics.json" : config.metricsFile);
+        simulationEngine.recordLoadTime(loadSeconds);
+    }
+    if (!config.checkpointDirectory.empty()) {
+        simulationEngine.setCheckpointPath(config.checkpointDirectory + "/checkpoint_" + skuData.sku + ".bin");
+        simulationEngine.setWarmStartIterations(config.warmStartIterations);
+    }
+}
+
+// Calibra el SKU una vez (o lo toma del checkpoint si sus entradas no cambiaron) y responde
+// las peticiones de queryPath ("-" = stdin) por stdout; el diagnóstico va a stderr
+int runQueries(const SimulationConfig& config, const std::string& queryPath, const std::string& batchPath,
+               const std::string& sku, const std::string& outputDirectory) {
+    SKUJob job = {"", "../data/matriz_intervals_df_Z285320_2024-07-22.csv",
+                  "../data/df_features_Z285320_sku_norm_2024-07-22.txt"};
+    if (!batchPath.empty()) {
+        std::vector<SKUJob> jobs = loadSKUJobs(batchPath);
+        auto found = std::find_if(jobs.begin(), jobs.end(), [&](const SKUJob& candidate) { return candidate.sku == sku; });
+        if (sku.empty() && jobs.size() == 1) {
+            found = jobs.begin();
+        }
+        if (found == jobs.end()) {
+            LOG_ERROR("SKU " << (sku.empty() ? "(none given)" : sku) << " not found in " << batchPath);
+            return 1;
+        }
+        job = *found;
+    }
+
+    std::ifstream queryFile;
+    if (queryPath != "-") {
+        queryFile.open(queryPath);
+        if (!queryFile.is_open()) {
+            LOG_ERROR("Could not open query file " << queryPath);
+            return 1;
+        }
+    }
+
+    auto loadStart = std::chrono::steady_clock::now();
+    SKUIntervalCache intervalCache;
+    SKUData skuData = intervalCache.load(job);
+    std::map<std::string, double> normalizedFeatures = loadNormalizedFeatures(job.featuresPath);
+    double loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - loadStart).count();
+
+    SimulationEngine simulationEngine;
+    configureEngine(simulationEngine, config, skuData, normalizedFeatures, outputDirectory, loadSeconds);
+    auto calibrationStart = std::chrono::steady_clock::now();
+    if (!simulationEngine.runSimulations(config.numberOfIterations, config.daysToSimulate, config.tolerance)) {
+        return 1;
+    }
+    double calibrationSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - calibrationStart).count();
+
+    ScenarioForecaster forecaster;
+    if (!forecaster.load(simulationEngine.getProductData(), simulationEngine.getNormalizedFeatures(),
+                         simulationEngine.getParameters())) {
+        return 1;
+    }
+    if (config.hasSeed) {
+        forecaster.setSeed(config.seed);
+    }
+
+    ConsoleSink output(stdout);
+    ScenarioServeSummary summary = serveScenarioQueries(forecaster, queryPath == "-" ? std::cin : queryFile, output,
+                                                        config.daysToSimulate, std::max(1, config.queryPaths));
+
+    std::cerr << "SKU " << forecaster.getSKU() << ": "
+              << (simulationEngine.wasSkipped() ? "calibration loaded from checkpoint" : "calibrated") << " in "
+              << calibrationSeconds * 1000.0 << " ms" << std::endl;
+    std::cerr << "Queries: " << summary.answered << " answered, " << summary.failed << " failed" << std::endl;
+    if (summary.answered > 0) {
+        std::cerr << "Latency: " << summary.totalSeconds / summary.answered * 1000.0 << " ms mean, "
+                  << summary.maxSeconds * 1000.0 << " ms max" << std::endl;
+    }
+    return summary.failed == 0 ? 0 : 2;
+}
+
+} // namespace
 
 int main(int argc, char* argv[]) {
     auto start = std::chrono::high_resolution_clock::now();
 
-    int numberOfIterations = 0;
-    double tolerance = 0.0;
-    int daysToSimulate = 0;
+    std::string configPath = "../data/simulation_config_initial.txt";
+    std::string batchPath;
+    std::string outputDirectory;
+    std::string snapshotPath;
+    std::string makeSnapshotPath;
+    std::string queryPath;
+    std::string sku;
+    int workers = -1;
+    int workerFd = -1;
 
-    loadSimulationConfig("../data/simulation_config_initial.txt", numberOfIterations, tolerance, daysToSimulate);
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--config" && i + 1 < argc) {
+            configPath = argv[++i];
+        } else if (arg == "--batch" && i + 1 < argc) {
+            batchPath = argv[++i];
+        } else if (arg == "--output" && i + 1 < argc) {
+            outputDirectory = argv[++i];
+        } else if (arg == "--snapshot" && i + 1 < argc) {
+            snapshotPath = argv[++i];
+        } else if (arg == "--make-snapshot" && i + 1 < argc) {
+            makeSnapshotPath = argv[++i];
+        } else if (arg == "--query" && i + 1 < argc) {
+            queryPath = argv[++i];
+        } else if (arg == "--sku" && i + 1 < argc) {
+            sku = argv[++i];
+        } else if (arg == "--workers" && i + 1 < argc) {
+            workers = std::atoi(argv[++i]);
+        } else if (arg == "--worker-fd" && i + 1 < argc) {
+            // Uso interno: proceso trabajador de ShardCoordinator
+            workerFd = std::atoi(argv[++i]);
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (!makeSnapshotPath.empty()) {
+        if (batchPath.empty()) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        return makeSnapshot(batchPath, makeSnapshotPath);
+    }
+
+    // En modo consulta stdout lleva solo las respuestas
+    if (!queryPath.empty()) {
+        Logger::setConsole(stderr);
+    }
+
+    SimulationConfig config;
+
+    loadSimulationConfig(configPath, config);
+
+    int numberOfIterations = config.numberOfIterations;
+    double tolerance = config.tolerance;
+    int daysToSimulate = config.daysToSimulate;
+
+    // --output tiene prioridad sobre outputDirectory del archivo de configuración
+    if (outputDirectory.empty()) {
+        outputDirectory = config.outputDirectory.empty() ? "../data/output" : config.outputDirectory;
+    }
+    if (workers >= 0) {
+        config.workerProcesses = workers;
+    }
+    // Los trabajadores escriben su diagnóstico por consola; el archivo de log es del coordinador
+    if (!config.logFile.empty() && workerFd < 0) {
+        std::unique_ptr<OutputSink> logSink = openFileSink(config.logFile, config.asyncOutput);
+        if (logSink->good()) {
+            Logger::setSink(std::move(logSink));
+        } else {
+            LOG_WARNING("Could not open log file " << config.logFile << ", logging to console");
+        }
+    }
 
     if (numberOfIterations == 0 || tolerance == 0.0 || daysToSimulate == 0) {
-        std::cerr << "Failed to load simulation configuration correctly." << std::endl;
+        LOG_ERROR("Failed to load simulation configuration correctly.");
         return 1;
     }
 
+    if (workerFd >= 0) {
+        return runShardWorker(config, outputDirectory, workerFd);
+    }
+    if (!queryPath.empty()) {
+        return runQueries(config, queryPath, batchPath, sku, outputDirectory);
+    }
+    if (!snapshotPath.empty()) {
+        return runSnapshotBatch(config, snapshotPath, outputDirectory);
+    }
+    if (!batchPath.empty() && config.workerProcesses > 0) {
+        return runShardedBatch(config, configPath, batchPath, outputDirectory, argv[0]);
+    }
+    if (!batchPath.empty()) {
+        return runBatch(config, batchPath, outputDirectory);
+    }
+
     SimulationEngine simulationEngine;
 
+    auto loadStart = std::chrono::steady_clock::now();
     SKUData skuData = loadSKUData("../data/matriz_intervals_df_Z285320_2024-07-22.csv");
     
     std::map<std::string, double> normalizedFeatures = loadNormalizedFeatures("../data/df_features_Z285320_sku_norm_2024-07-22.txt");
     
-    simulationEngine.setProductData(skuData);
-    simulationEngine.setNormalizedFeatures(normalizedFeatures);
+    configureEngine(simulationEngine, config, skuData, normalizedFeatures, outputDirectory,
+                    std::chrono::duration<double>(std::chrono::steady_clock::now() - loadStart).count());
     
     simulationEngine.runSimulations(numberOfIterations, daysToSimulate, tolerance);
 
@@ -41,6 +311,7 @@ int main(int argc, char* argv[]) {
     std::cout << "numberOfIterations: " << numberOfIterations << std::endl;
     std::cout << "tolerance: " << tolerance << std::endl;
     std::cout << "daysToSimulate: " << daysToSimulate << std::endl;
+    std::cout << "numberOfThreads: " << config.numberOfThreads << std::endl;
     std::cout << "\n";
 
     auto end = std::chrono::high_resolution_clock::now();
@@ -0,0 +1,27 @@
+#ifndef CHECK_H
+#define CHECK_H
+
+#include <iostream>
+
+// Comprobaciones de las pruebas, sin dependencias externas. Cada fallo se informa con su
+// archivo y línea; el main de la prueba devuelve testResult() como código de salida para CTest.
+inline int& testFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(condition)                                                                   \
+    do {                                                                                   \
+        if (!(condition)) {                                                                \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #condition ") failed\n"; \
+            ++testFailures();                                                              \
+        }                                                                                  \
+    } while (0)
+
+inline int testResult(const char* name) {
+    std::cerr << name << ": " << (testFailures() == 0 ? "passed" : "FAILED") << " (" << testFailures()
+              << " failed checks)" << std::endl;
+    return testFailures() == 0 ? 0 : 1;
+}
+
+#endif // CHECK_H
@@ -0,0 +1,125 @@
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+#include "../include/BatchRunner.h"
+#include "../include/DataLoader.h"
+#include "../include/FastParse.h"
+#include "../include/Logger.h"
+#include "../include/RandomEngine.h"
+#include "Check.h"
+
+namespace {
+
+bool sameBits(double a, double b) {
+    return std::memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+// parseDouble y strtod deben dar el mismo double y consumir los mismos caracteres
+bool matchesStrtod(const char* text) {
+    const char* end = text + std::strlen(text);
+    const char* p = text;
+    double value = 0.0;
+    const bool parsed = parseDouble(p, end, value);
+
+    char* strtodEnd = nullptr;
+    const double expected = std::strtod(text, &strtodEnd);
+    if (strtodEnd == text) {
+        return !parsed;
+    }
+    return parsed && sameBits(value, expected) && p == strtodEnd;
+}
+
+void parseDoubleMatchesStrtod() {
+    // Bordes del camino rápido (19 dígitos, exponente 22, mantisa 2^53) y casos que van a strtod
+    const char* cases[] = {"0", "-0", "+0.0", "1", "-1.5", "0.1", "3.14159", "1e22", "1e23", "1e-22", "1e-23",
+                           "9007199254740992", "9007199254740993", "1234567890123456789", "12345678901234567890",
+                           "0.000000000000000000012345", "1.7976931348623157e308", "4.9e-324", "2.2250738585072014e-308",
+                           "1e400", "1e-400", "1797693134862315708145274237317043567980705675258449965989174768031572607800285387605895586327668781715404589535143824642343213268894641827684675467035375169860499105765512820762454900903893289440758685541792126179325598913479211111111111111111111.5", "1e", "1e+", "5.", ".5", "-.25e2", "00012.500", "7;8", "(1.5, 2)"};
+    for (const char* text : cases) {
+        if (!matchesStrtod(text)) {
+            std::cerr << "parseDouble differs from strtod on \"" << text << "\"" << std::endl;
+            CHECK(false);
+        }
+    }
+
+    const char* formats[] = {"%.17g", "%.6f", "%.3e", "%g", "%.0f", "%.20f", "%.12e"};
+    RandomEngine rng(3);
+    int mismatches = 0;
+    for (int i = 0; i < 100000; ++i) {
+        double value;
+        if (i % 2 == 0) {
+            // Cualquier patrón de bits finito
+            std::uint64_t bits = rng();
+            std::memcpy(&value, &bits, sizeof(value));
+            if (!std::isfinite(value)) {
+                continue;
+            }
+        } else {
+            value = rng.uniform() * 2e4 - 1e4;
+        }
+        char text[400];
+        std::snprintf(text, sizeof(text), formats[i % 7], value);
+        mismatches += matchesStrtod(text) ? 0 : 1;
+    }
+    CHECK(mismatches == 0);
+}
+
+std::string writeTempFile(const std::string& content) {
+    char path[] = "/tmp/abc_data_loader_testXXXXXX";
+    const int fd = mkstemp(path);
+    if (fd < 0) {
+        return "";
+    }
+    const ssize_t written = write(fd, content.data(), content.size());
+    close(fd);
+    return written == static_cast<ssize_t>(content.size()) ? path : "";
+}
+
+// Varias filas en un archivo: celdas vacías al final, CRLF y una fila mal formada que se salta
+void loadsMultiSKUIntervalFiles() {
+    const std::string path = writeTempFile(
+        "sku;list_products_1;list_products_2;list_products_3;min_price;max_price\r\n"
+        "A;(1, 2);(3.5, 4);(5,6);1;6\r\n"
+        "B;(10, 20);;;10;20\r\n"
+        "C;(x);;;1;2\n"
+        "D;(1,2);(2,3);(3,4);1;4");
+    CHECK(!path.empty());
+
+    const std::vector<SKUData> rows = loadSKUDataset(path);
+    CHECK(rows.size() == 3);
+    if (rows.size() == 3) {
+        CHECK(rows[0].sku == "A" && rows[0].listProducts.size() == 3 && rows[0].listProducts[1].first == 3.5);
+        CHECK(rows[1].sku == "B" && rows[1].listProducts.size() == 1 && rows[1].globalMaxPrice == 20.0);
+        CHECK(rows[2].sku == "D" && rows[2].intervals.size() == 3);
+    }
+
+    // Los trabajos de un lote toman la fila de su SKU del archivo compartido
+    SKUIntervalCache cache;
+    const SKUJob jobB = {"B", path, ""};
+    const SKUJob jobD = {"D", path, ""};
+    const SKUJob missing = {"Z", path, ""};
+    CHECK(cache.load(jobB).globalMinPrice == 10.0);
+    CHECK(cache.load(jobD).sku == "D");
+    CHECK(cache.load(missing).listProducts.empty());
+
+    // Un archivo de una sola fila vale para su trabajo aunque la columna sku no coincida
+    const std::string single = writeTempFile("sku;list_products_1;min_price;max_price\nOTHER;(1, 2);1;2\n");
+    const SKUJob singleJob = {"S", single, ""};
+    CHECK(cache.load(singleJob).listProducts.size() == 1);
+
+    std::remove(path.c_str());
+    std::remove(single.c_str());
+}
+
+} // namespace
+
+int main() {
+    Logger::setLevel(LogLevel::Off);
+    parseDoubleMatchesStrtod();
+    loadsMultiSKUIntervalFiles();
+    return testResult("DataLoaderTest");
+}
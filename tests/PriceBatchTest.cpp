@@ -0,0 +1,91 @@
+#include <cstring>
+#include <vector>
+#include "../include/ABCMethod.h"
+#include "../include/Logger.h"
+#include "../include/PriceBatch.h"
+#include "Check.h"
+#include "TestData.h"
+
+namespace {
+
+bool sameBits(const std::vector<double>& a, const std::vector<double>& b) {
+    return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(double)) == 0;
+}
+
+TransitionModel makeModel(int intervals) {
+    SKUData skuData = makeTestSKU(intervals);
+    // Un tramo de ancho 0 al final: su precio no depende del uniforme
+    const double last = skuData.listProducts.back().second;
+    skuData.listProducts.push_back(std::make_pair(last, last));
+    TransitionModel model;
+    model.build(skuData, makeTestFeatures(), makeTestParameters(0.8));
+    return model;
+}
+
+// 7 y 30 días usan kernels especializados y 45 el genérico; los lotes que no son múltiplo
+// de 4 terminan en el kernel escalar también con AVX2
+void avx2KernelMatchesScalarKernel() {
+    if (detectSimdLevel() != SimdLevel::AVX2) {
+        std::cerr << "AVX2 not available, only the scalar kernel is checked" << std::endl;
+        return;
+    }
+    for (int intervals : {1, 5, 60}) {
+        const TransitionModel model = makeModel(intervals);
+        for (int days : {7, 30, 45}) {
+            for (int paths : {1, 4, 13, 256}) {
+                const RandomEngine rng(1000 + days * paths);
+                PriceBatch scalar;
+                PriceBatch avx2;
+                simulateModelPriceBatch(model, paths, days, rng, scalar, SimdLevel::Scalar);
+                simulateModelPriceBatch(model, paths, days, rng, avx2, SimdLevel::AVX2);
+                CHECK(avx2.pathCount == paths && avx2.dayCount == days);
+                CHECK(sameBits(scalar.prices, avx2.prices));
+            }
+        }
+    }
+}
+
+// El camino p del lote es el de simulatePricePath sobre rng.split(p)
+void batchMatchesSinglePaths() {
+    ABCMethod abcMethod;
+    const TransitionModel model = makeModel(60);
+    for (SimdLevel level : {SimdLevel::Scalar, detectSimdLevel()}) {
+        const int days = 30;
+        const int paths = 37;
+        const RandomEngine rng(7);
+        PriceBatch batch;
+        simulateModelPriceBatch(model, paths, days, rng, batch, level);
+
+        std::vector<double> path(days);
+        for (int p = 0; p < paths; ++p) {
+            RandomEngine pathEngine = rng.split(p);
+            abcMethod.simulatePricePath(model, days, pathEngine, path.data());
+            std::vector<double> column(days);
+            for (int d = 0; d < days; ++d) {
+                column[d] = batch.at(p, d);
+            }
+            CHECK(sameBits(path, column));
+        }
+    }
+}
+
+void pricesStayInTheirIntervals() {
+    const SKUData skuData = makeTestSKU(60);
+    TransitionModel model;
+    model.build(skuData, makeTestFeatures(), makeTestParameters(0.3));
+    PriceBatch batch;
+    simulateModelPriceBatch(model, 100, 30, RandomEngine(3), batch, detectSimdLevel());
+    for (double price : batch.prices) {
+        CHECK(price >= skuData.globalMinPrice && price < skuData.globalMaxPrice);
+    }
+}
+
+} // namespace
+
+int main() {
+    Logger::setLevel(LogLevel::Warning);
+    avx2KernelMatchesScalarKernel();
+    batchMatchesSinglePaths();
+    pricesStayInTheirIntervals();
+    return testResult("PriceBatchTest");
+}
@@ -0,0 +1,64 @@
+#include <vector>
+#include "../include/ABCMethod.h"
+#include "../include/Logger.h"
+#include "Check.h"
+#include "TestData.h"
+
+namespace {
+
+struct RefineResult {
+    std::vector<double> probabilities;
+    std::vector<double> accepted;
+    std::vector<double> distances;
+};
+
+// Tres rondas de refineParameters con la semilla dada, repartidas en threads hilos
+RefineResult refine(unsigned long long seed, int threads) {
+    const SKUData skuData = makeTestSKU(40);
+    const std::map<std::string, double> features = makeTestFeatures();
+    std::vector<Parameter> parameters = makeTestParameters(0.5);
+
+    ABCMethod abcMethod;
+    abcMethod.setSeed(seed);
+    abcMethod.setNumberOfThreads(threads);
+    abcMethod.setNumberOfSimulations(500);
+    abcMethod.setDistanceMetric(DistanceMetricType::Moments);
+    for (int round = 0; round < 3; ++round) {
+        abcMethod.refineParameters(parameters, skuData, features, 30, 60.0);
+    }
+
+    RefineResult result;
+    for (const auto& parameter : parameters) {
+        result.probabilities.push_back(parameter.probability);
+    }
+    abcMethod.getLastAccepted(result.accepted, result.distances);
+    return result;
+}
+
+// Las semillas dependen de (ronda, propuesta) y no del hilo: el posterior es el mismo bit a bit
+void sameSeedGivesSameResultForAnyThreadCount() {
+    const RefineResult reference = refine(42, 1);
+    // La tolerancia debe aceptar unas propuestas y rechazar otras para que la prueba diga algo
+    CHECK(!reference.distances.empty());
+    CHECK(reference.distances.size() < 500);
+
+    for (int threads : {2, 3, 8}) {
+        const RefineResult result = refine(42, threads);
+        CHECK(result.probabilities == reference.probabilities);
+        CHECK(result.accepted == reference.accepted);
+        CHECK(result.distances == reference.distances);
+    }
+}
+
+void differentSeedsGiveDifferentResults() {
+    CHECK(refine(1, 2).probabilities != refine(2, 2).probabilities);
+}
+
+} // namespace
+
+int main() {
+    Logger::setLevel(LogLevel::Warning);
+    sameSeedGivesSameResultForAnyThreadCount();
+    differentSeedsGiveDifferentResults();
+    return testResult("RefineParametersTest");
+}
@@ -0,0 +1,46 @@
+#ifndef TESTDATA_H
+#define TESTDATA_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include "../include/Parameter.h"
+#include "../include/SKUData.h"
+
+// SKU sintético: count tramos contiguos de anchos distintos a partir de 100
+inline SKUData makeTestSKU(int count) {
+    SKUData data;
+    data.sku = "TEST";
+    double lower = 100.0;
+    for (int i = 0; i < count; ++i) {
+        const double width = 5.0 + (i * 7) % 11;
+        data.listProducts.push_back(std::make_pair(lower, lower + width));
+        PriceInterval interval = {lower, lower + width, 0};
+        data.intervals.push_back(interval);
+        lower += width;
+    }
+    data.globalMinPrice = data.listProducts.front().first;
+    data.globalMaxPrice = data.listProducts.back().second;
+    buildIntervalIndex(data);
+    return data;
+}
+
+// Features normalizadas con el mismo nombre que los parámetros de makeTestParameters
+inline std::map<std::string, double> makeTestFeatures() {
+    std::map<std::string, double> features;
+    features["client"] = 0.4;
+    features["vendor_numeric"] = -0.7;
+    features["year"] = 1.2;
+    features["month"] = -0.3;
+    return features;
+}
+
+inline std::vector<Parameter> makeTestParameters(double probability) {
+    std::vector<Parameter> parameters;
+    for (const auto& feature : makeTestFeatures()) {
+        parameters.push_back(Parameter(feature.first, probability));
+    }
+    return parameters;
+}
+
+#endif // TESTDATA_H
@@ -0,0 +1,283 @@
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/stat.h>
+#include "../include/RandomEngine.h"
+
+// Generador de SKU sintéticos con el formato de entrada real, para probar la escala:
+// matriz_intervals_df_<SKU>_<fecha>.csv y df_features_<SKU>_sku_norm_<fecha>.txt por SKU, y
+// un manifiesto (sku;ruta_intervalos;ruta_features) con rutas absolutas.
+//
+// El número de tramos sigue una distribución log-uniforme (muchos SKU pequeños y pocos muy
+// grandes), el precio inicial una log-normal y el ancho de cada tramo varía alrededor del
+// ancho típico del SKU, con tramos contiguos como en los datos reales. El SKU i usa el
+// subflujo i de la semilla: el resultado no depende del número de hilos.
+
+namespace {
+
+const char* const FEATURE_NAMES[] = {
+    "client_numeric", "vendor_numeric", "year", "month", "day",
+    "sku_count_products", "total_num_count_products", "total_price_products"
+};
+
+struct GeneratorSettings {
+    std::string outputDirectory;
+    long long skus = 1000;
+    int minIntervals = 5;
+    int maxIntervals = 200;
+    int features = 8;
+    unsigned long long seed = 1;
+    std::string date = "2024-07-22";
+    long long filesPerDirectory = 10000;    // SKU por subdirectorio; 0 = todos en outputDirectory
+    int threads = 1;
+};
+
+struct GeneratedTotals {
+    long long skus = 0;
+    long long intervals = 0;
+    long long failed = 0;
+    int minIntervals = INT_MAX;
+    int maxIntervals = 0;
+};
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " --output <directory> [--skus <n>] [--min-intervals <n>] [--max-intervals <n>]\n"
+              << "       [--features <n>] [--seed <n>] [--date <yyyy-mm-dd>] [--files-per-directory <n>] [--threads <n>]" << std::endl;
+}
+
+double normal(RandomEngine& rng) {
+    // Box-Muller con nuestro generador: los archivos no dependen de la biblioteca estándar
+    const double u = 1.0 - rng.uniform();
+    const double v = rng.uniform();
+    return std::sqrt(-2.0 * std::log(u)) * std::cos(6.283185307179586 * v);
+}
+
+std::string skuName(long long index) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "S%08lld", index);
+    return name;
+}
+
+std::string directoryFor(const GeneratorSettings& settings, long long index) {
+    if (settings.filesPerDirectory <= 0 || settings.skus <= settings.filesPerDirectory) {
+        return settings.outputDirectory;
+    }
+    char shard[32];
+    std::snprintf(shard, sizeof(shard), "/%05lld", index / settings.filesPerDirectory);
+    return settings.outputDirectory + shard;
+}
+
+std::string intervalsPath(const GeneratorSettings& settings, long long index) {
+    return directoryFor(settings, index) + "/matriz_intervals_df_" + skuName(index) + "_" + settings.date + ".csv";
+}
+
+std::string featuresPath(const GeneratorSettings& settings, long long index) {
+    return directoryFor(settings, index) + "/df_features_" + skuName(index) + "_sku_norm_" + settings.date + ".txt";
+}
+
+bool makeDirectory(const std::string& path) {
+    return mkdir(path.c_str(), 0755) == 0 || errno == EEXIST;
+}
+
+bool writeFile(const std::string& path, const std::string& content) {
+    FILE* file = std::fopen(path.c_str(), "w");
+    if (file == nullptr) {
+        return false;
+    }
+    const bool written = std::fwrite(content.data(), 1, content.size(), file) == content.size();
+    return std::fclose(file) == 0 && written;
+}
+
+void appendInterval(std::string& text, long long lower, long long upper) {
+    char buffer[64];
+    int length = std::snprintf(buffer, sizeof(buffer), ";(%lld, %lld)", lower, upper);
+    text.append(buffer, static_cast<size_t>(length));
+}
+
+// Escribe los dos archivos del SKU index; devuelve su número de tramos (0 si falló)
+int generateSKU(const GeneratorSettings& settings, const RandomEngine& master, long long index,
+                std::string& intervalsText, std::string& featuresText) {
+    RandomEngine rng = master.split(static_cast<std::uint64_t>(index));
+    const std::string sku = skuName(index);
+
+    const double logMin = std::log(static_cast<double>(settings.minIntervals));
+    const double logMax = std::log(static_cast<double>(settings.maxIntervals) + 1.0);
+    const int intervalCount = std::max(settings.minIntervals,
+                                       std::min(settings.maxIntervals, static_cast<int>(std::exp(rng.uniform(logMin, logMax)))));
+
+    // Precio inicial log-normal alrededor de 2000 y ancho típico entre el 3% y el 12% de él
+    const long long start = std::max(1LL, std::llround(std::exp(std::log(2000.0) + 0.8 * normal(rng))));
+    const double typicalWidth = std::max(1.0, start * rng.uniform(0.03, 0.12));
+
+    intervalsText.assign("sku");
+    for (int k = 0; k < intervalCount; ++k) {
+        intervalsText += ";list_products_" + std::to_string(k + 1);
+    }
+    intervalsText += ";min_price;max_price\n";
+    intervalsText += sku;
+
+    long long lower = start;
+    long long upper = start;
+    for (int k = 0; k < intervalCount; ++k) {
+        long long width = std::max(1LL, std::llround(typicalWidth * rng.uniform(0.8, 1.2)));
+        // El último tramo suele quedar recortado por el precio máximo, como en los datos reales
+        if (k == intervalCount - 1 && rng.uniform() < 0.5) {
+            width = std::max(1LL, std::llround(width * rng.uniform(0.1, 1.0)));
+        }
+        upper = lower + width;
+        appendInterval(intervalsText, lower, upper);
+        lower = upper + 1;
+    }
+    intervalsText += ";" + std::to_string(start) + ";" + std::to_string(upper) + "\n";
+
+    // Features normalizadas: media 0 y desviación 1, con colas algo más pesadas en algunas
+    featuresText.clear();
+    const long long products = 1 + static_cast<long long>(rng.uniformIndex(999999));
+    char line[160];
+    for (int f = 0; f < settings.features; ++f) {
+        const std::string name = f < 8 ? FEATURE_NAMES[f] : "feature_" + std::to_string(f);
+        const double value = normal(rng) * (rng.uniform() < 0.1 ? 2.0 : 1.0);
+        int length = std::snprintf(line, sizeof(line), "%s: ['%lld (%f)']\n", name.c_str(), products, value);
+        featuresText.append(line, static_cast<size_t>(length));
+    }
+
+    if (!writeFile(intervalsPath(settings, index), intervalsText) || !writeFile(featuresPath(settings, index), featuresText)) {
+        return 0;
+    }
+    return intervalCount;
+}
+
+bool parseArguments(int argc, char* argv[], GeneratorSettings& settings) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            return false;
+        }
+        const char* value = argv[++i];
+        if (arg == "--output") {
+            settings.outputDirectory = value;
+        } else if (arg == "--skus") {
+            settings.skus = std::atoll(value);
+        } else if (arg == "--min-intervals") {
+            settings.minIntervals = std::atoi(value);
+        } else if (arg == "--max-intervals") {
+            settings.maxIntervals = std::atoi(value);
+        } else if (arg == "--features") {
+            settings.features = std::atoi(value);
+        } else if (arg == "--seed") {
+            settings.seed = std::strtoull(value, nullptr, 10);
+        } else if (arg == "--date") {
+            settings.date = value;
+        } else if (arg == "--files-per-directory") {
+            settings.filesPerDirectory = std::atoll(value);
+        } else if (arg == "--threads") {
+            settings.threads = std::atoi(value);
+        } else {
+            return false;
+        }
+    }
+    return !settings.outputDirectory.empty() && settings.skus > 0 && settings.minIntervals > 0 &&
+           settings.maxIntervals >= settings.minIntervals && settings.features > 0 && settings.threads > 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    GeneratorSettings settings;
+    if (!parseArguments(argc, argv, settings)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    // Rutas absolutas en el manifiesto: sirve desde cualquier directorio de trabajo
+    if (!makeDirectory(settings.outputDirectory)) {
+        std::cerr << "Could not create directory " << settings.outputDirectory << std::endl;
+        return 1;
+    }
+    char* absolute = realpath(settings.outputDirectory.c_str(), nullptr);
+    if (absolute != nullptr) {
+        settings.outputDirectory = absolute;
+        std::free(absolute);
+    }
+    const long long perDirectory = settings.filesPerDirectory > 0 ? settings.filesPerDirectory : settings.skus;
+    for (long long first = 0; first < settings.skus; first += perDirectory) {
+        if (!makeDirectory(directoryFor(settings, first))) {
+            std::cerr << "Could not create directory " << directoryFor(settings, first) << std::endl;
+            return 1;
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    const RandomEngine master(settings.seed);
+    std::atomic<long long> next(0);
+    std::vector<GeneratedTotals> totals(settings.threads);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < settings.threads; ++t) {
+        threads.emplace_back([&settings, &master, &next, &totals, t]() {
+            GeneratedTotals& local = totals[t];
+            std::string intervalsText;
+            std::string featuresText;
+            // Bloques de 64 SKU por hilo: poca contención en el contador compartido
+            for (long long first = next.fetch_add(64); first < settings.skus; first = next.fetch_add(64)) {
+                const long long last = std::min(settings.skus, first + 64);
+                for (long long i = first; i < last; ++i) {
+                    const int intervals = generateSKU(settings, master, i, intervalsText, featuresText);
+                    if (intervals == 0) {
+                        ++local.failed;
+                        continue;
+                    }
+                    ++local.skus;
+                    local.intervals += intervals;
+                    local.minIntervals = std::min(local.minIntervals, intervals);
+                    local.maxIntervals = std::max(local.maxIntervals, intervals);
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    GeneratedTotals total;
+    for (const auto& local : totals) {
+        total.skus += local.skus;
+        total.intervals += local.intervals;
+        total.failed += local.failed;
+        total.minIntervals = std::min(total.minIntervals, local.minIntervals);
+        total.maxIntervals = std::max(total.maxIntervals, local.maxIntervals);
+    }
+
+    const std::string manifestPath = settings.outputDirectory + "/manifest.txt";
+    FILE* manifest = std::fopen(manifestPath.c_str(), "w");
+    bool manifestWritten = manifest != nullptr;
+    for (long long i = 0; i < settings.skus && manifestWritten; ++i) {
+        const std::string line = skuName(i) + ";" + intervalsPath(settings, i) + ";" + featuresPath(settings, i) + "\n";
+        manifestWritten = std::fwrite(line.data(), 1, line.size(), manifest) == line.size();
+    }
+    if (manifest != nullptr) {
+        manifestWritten = std::fclose(manifest) == 0 && manifestWritten;
+    }
+    if (!manifestWritten) {
+        std::cerr << "Could not write manifest " << manifestPath << std::endl;
+        return 1;
+    }
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "SKUs: " << total.skus << " written, " << total.failed << " failed" << std::endl;
+    if (total.skus > 0) {
+        std::cout << "Intervals per SKU: " << total.minIntervals << " min, "
+                  << static_cast<double>(total.intervals) / total.skus << " mean, " << total.maxIntervals << " max" << std::endl;
+    }
+    std::cout << "Time: " << seconds << " seconds (" << total.skus / std::max(seconds, 1e-9) << " SKUs/second)" << std::endl;
+    std::cout << "Manifest: " << manifestPath << std::endl;
+    return total.failed == 0 ? 0 : 2;
+}
@@ -0,0 +1,339 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/resource.h>
+#include "../include/BatchRunner.h"
+#include "../include/DataLoader.h"
+#include "../include/Logger.h"
+#include "../include/SimulationEngine.h"
+
+// Prueba de carga de extremo a extremo sobre datos generados (generate_skus): cada SKU pasa
+// por DataLoader y por un SimulationEngine propio, como en BatchRunner, y se mide cada etapa.
+// Informa del rendimiento, del pico de memoria residente y de los percentiles de latencia de
+// cada etapa; con --json deja lo mismo en un archivo para comparar ejecuciones.
+
+namespace {
+
+enum Stage {
+    LoadStage = 0,      // SKUIntervalCache::load + loadNormalizedFeatures
+    CalibrateStage,     // runSimulations
+    WriteStage,         // log y estadísticas del SKU (solo con --output)
+    TotalStage,
+    StageCount
+};
+
+const char* const STAGE_NAMES[StageCount] = {"load", "calibrate", "write", "total"};
+
+const double MIN_SECONDS = 1e-7;
+const double PER_DECADE = 100.0;
+const int BUCKETS = 1100;
+
+// Histograma de latencias en escala logarítmica (100 cubetas por década, error relativo
+// < 2.5%, de 100 ns a 10^4 s). Memoria constante y se puede sumar entre hilos: con millones
+// de SKU las muestras no inflan el pico de memoria que se quiere medir.
+class LatencyHistogram {
+public:
+    LatencyHistogram() : buckets(BUCKETS, 0), count(0), sum(0.0), maximum(0.0) {}
+
+    void add(double seconds) {
+        const double position = (std::log10(std::max(seconds, MIN_SECONDS)) - std::log10(MIN_SECONDS)) * PER_DECADE;
+        ++buckets[std::min(BUCKETS - 1, static_cast<int>(position))];
+        ++count;
+        sum += seconds;
+        maximum = std::max(maximum, seconds);
+    }
+
+    void merge(const LatencyHistogram& other) {
+        for (int b = 0; b < BUCKETS; ++b) {
+            buckets[b] += other.buckets[b];
+        }
+        count += other.count;
+        sum += other.sum;
+        maximum = std::max(maximum, other.maximum);
+    }
+
+    long long size() const { return count; }
+    double mean() const { return count > 0 ? sum / count : 0.0; }
+    double max() const { return maximum; }
+
+    // Centro geométrico de la cubeta que contiene el cuantil q, sin pasar del máximo observado
+    double quantile(double q) const {
+        if (count == 0) {
+            return 0.0;
+        }
+        const long long rank = std::max(1LL, static_cast<long long>(std::ceil(q * count)));
+        long long cumulative = 0;
+        for (int b = 0; b < BUCKETS; ++b) {
+            cumulative += buckets[b];
+            if (cumulative >= rank) {
+                return std::min(maximum, MIN_SECONDS * std::pow(10.0, (b + 0.5) / PER_DECADE));
+            }
+        }
+        return maximum;
+    }
+
+private:
+    std::vector<long long> buckets;
+    long long count;
+    double sum;
+    double maximum;
+};
+
+struct WorkerTotals {
+    LatencyHistogram stages[StageCount];
+    long long succeeded = 0;
+    long long failed = 0;
+    long long intervals = 0;
+};
+
+struct LoadTestSettings {
+    std::string batchPath;
+    std::string configPath;
+    std::string outputDirectory;    // vacío: la salida de cada SKU queda en memoria y se descarta
+    std::string jsonPath;
+    long long limit = 0;            // 0 = todos los SKU
+    int threads = 0;                // 0 = numberOfThreads de la configuración
+};
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " --batch <manifest|directory> [--config <file>] [--limit <n>] [--threads <n>]\n"
+              << "       [--output <directory>] [--json <file>]" << std::endl;
+}
+
+bool parseArguments(int argc, char* argv[], LoadTestSettings& settings) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            return false;
+        }
+        const char* value = argv[++i];
+        if (arg == "--batch") {
+            settings.batchPath = value;
+        } else if (arg == "--config") {
+            settings.configPath = value;
+        } else if (arg == "--output") {
+            settings.outputDirectory = value;
+        } else if (arg == "--json") {
+            settings.jsonPath = value;
+        } else if (arg == "--limit") {
+            settings.limit = std::atoll(value);
+        } else if (arg == "--threads") {
+            settings.threads = std::atoi(value);
+        } else {
+            return false;
+        }
+    }
+    return !settings.batchPath.empty() && settings.limit >= 0 && settings.threads >= 0;
+}
+
+// Pico de memoria residente del proceso, en KiB (Linux)
+long long peakRSSKiB() {
+    struct rusage usage;
+    return getrusage(RUSAGE_SELF, &usage) == 0 ? static_cast<long long>(usage.ru_maxrss) : 0;
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool writeText(const std::string& path, const std::string& text) {
+    FILE* file = std::fopen(path.c_str(), "w");
+    if (file == nullptr) {
+        return false;
+    }
+    const bool written = std::fwrite(text.data(), 1, text.size(), file) == text.size();
+    return std::fclose(file) == 0 && written;
+}
+
+// Un SKU completo, con la misma configuración del motor que BatchRunner
+void runSKU(const SimulationConfig& config, const SKUJob& job, const std::string& outputDirectory,
+            SKUIntervalCache& intervalCache, WorkerTotals& totals) {
+    auto start = std::chrono::steady_clock::now();
+
+    SKUData skuData = intervalCache.load(job);
+    std::map<std::string, double> normalizedFeatures = loadNormalizedFeatures(job.featuresPath);
+    const double loadSeconds = secondsSince(start);
+    totals.stages[LoadStage].add(loadSeconds);
+    if (skuData.listProducts.empty()) {
+        ++totals.failed;
+        return;
+    }
+    totals.intervals += static_cast<long long>(skuData.listProducts.size());
+
+    auto calibrateStart = std::chrono::steady_clock::now();
+    SimulationEngine simulationEngine;
+    simulationEngine.setProductData(skuData);
+    simulationEngine.setNormalizedFeatures(normalizedFeatures);
+    simulationEngine.setNumberOfThreads(1);
+    simulationEngine.setNumberOfSimulations(config.numberOfSimulations);
+    simulationEngine.setSampler(config.sampler);
+    simulationEngine.setDistanceMetric(config.distanceMetric);
+    simulationEngine.setRegressionAdjustment(config.regressionAdjustment);
+    simulationEngine.setSMCSettings(config.smc);
+    if (config.hasSeed) {
+        simulationEngine.setSeed(batchSeedFor(config.seed, job.sku));
+    }
+    simulationEngine.setBufferedOutput(true);
+    const bool calibrated = simulationEngine.runSimulations(config.numberOfIterations, config.daysToSimulate,
+                                                            config.tolerance);
+    totals.stages[CalibrateStage].add(secondsSince(calibrateStart));
+
+    bool written = true;
+    std::string log;
+    std::string stats;
+    simulationEngine.takeBufferedOutput(log, stats);
+    if (!outputDirectory.empty()) {
+        auto writeStart = std::chrono::steady_clock::now();
+        written = writeText(outputDirectory + "/simulation_log_" + job.sku + ".txt", log) &&
+                  writeText(outputDirectory + "/statistics_simulations_" + job.sku + ".txt", stats);
+        totals.stages[WriteStage].add(secondsSince(writeStart));
+    }
+
+    totals.stages[TotalStage].add(secondsSince(start));
+    ++(calibrated && written ? totals.succeeded : totals.failed);
+}
+
+void printStage(const char* name, const LatencyHistogram& histogram) {
+    std::printf("  %-10s %10lld %12.3f %12.3f %12.3f %12.3f %12.3f\n", name, histogram.size(), histogram.mean() * 1e3,
+                histogram.quantile(0.5) * 1e3, histogram.quantile(0.9) * 1e3, histogram.quantile(0.99) * 1e3,
+                histogram.max() * 1e3);
+}
+
+bool writeJSON(const std::string& path, const LoadTestSettings& settings, const SimulationConfig& config,
+               const WorkerTotals& totals, int threads, double seconds, long long startRSS, long long peakRSS) {
+    FILE* file = std::fopen(path.c_str(), "w");
+    if (file == nullptr) {
+        return false;
+    }
+    const long long skus = totals.succeeded + totals.failed;
+    std::fprintf(file, "{\n  \"batch\": \"%s\",\n", settings.batchPath.c_str());
+    std::fprintf(file, "  \"threads\": %d,\n  \"numberOfIterations\": %d,\n  \"daysToSimulate\": %d,\n", threads,
+                 config.numberOfIterations, config.daysToSimulate);
+    std::fprintf(file, "  \"skus\": %lld,\n  \"failed\": %lld,\n  \"intervals\": %lld,\n", skus, totals.failed,
+                 totals.intervals);
+    std::fprintf(file, "  \"seconds\": %.6f,\n  \"skusPerSecond\": %.3f,\n  \"intervalsPerSecond\": %.3f,\n", seconds,
+                 skus / std::max(seconds, 1e-9), totals.intervals / std::max(seconds, 1e-9));
+    std::fprintf(file, "  \"startRSSKiB\": %lld,\n  \"peakRSSKiB\": %lld,\n  \"stagesMilliseconds\": {\n", startRSS, peakRSS);
+    bool first = true;
+    for (int s = 0; s < StageCount; ++s) {
+        const LatencyHistogram& histogram = totals.stages[s];
+        if (histogram.size() == 0) {
+            continue;
+        }
+        std::fprintf(file, "%s    \"%s\": {\"count\": %lld, \"mean\": %.6f, \"p50\": %.6f, \"p90\": %.6f, \"p99\": %.6f, \"max\": %.6f}",
+                     first ? "" : ",\n", STAGE_NAMES[s], histogram.size(), histogram.mean() * 1e3,
+                     histogram.quantile(0.5) * 1e3, histogram.quantile(0.9) * 1e3, histogram.quantile(0.99) * 1e3,
+                     histogram.max() * 1e3);
+        first = false;
+    }
+    std::fprintf(file, "\n  }\n}\n");
+    return std::fclose(file) == 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    LoadTestSettings settings;
+    if (!parseArguments(argc, argv, settings)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    // Solo avisos: el registro por SKU distorsionaría los tiempos
+    Logger::setLevel(LogLevel::Warning);
+
+    // Calibración corta por defecto; --config la sustituye por la de producción
+    SimulationConfig config;
+    config.numberOfIterations = 5;
+    config.tolerance = 13.0;
+    config.daysToSimulate = 30;
+    config.hasSeed = true;
+    config.seed = 1;
+    if (!settings.configPath.empty()) {
+        loadSimulationConfig(settings.configPath, config);
+    }
+    if (config.numberOfIterations <= 0 || config.tolerance <= 0.0 || config.daysToSimulate <= 0) {
+        std::cerr << "Invalid simulation configuration" << std::endl;
+        return 1;
+    }
+
+    std::vector<SKUJob> jobs = loadSKUJobs(settings.batchPath);
+    if (settings.limit > 0 && static_cast<long long>(jobs.size()) > settings.limit) {
+        jobs.resize(static_cast<size_t>(settings.limit));
+    }
+    if (jobs.empty()) {
+        std::cerr << "No SKU jobs found in " << settings.batchPath << std::endl;
+        return 1;
+    }
+
+    int threads = settings.threads > 0 ? settings.threads : config.numberOfThreads;
+    if (threads <= 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = std::min(threads, static_cast<int>(jobs.size()));
+
+    // La lista de trabajos ya está en memoria: el pico se compara con este punto de partida
+    const long long startRSS = peakRSSKiB();
+    auto start = std::chrono::steady_clock::now();
+
+    std::atomic<size_t> next(0);
+    SKUIntervalCache intervalCache;
+    std::vector<WorkerTotals> workerTotals(threads);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&config, &jobs, &settings, &next, &intervalCache, &workerTotals, t]() {
+            for (size_t i = next++; i < jobs.size(); i = next++) {
+                runSKU(config, jobs[i], settings.outputDirectory, intervalCache, workerTotals[t]);
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    const double seconds = secondsSince(start);
+    const long long peakRSS = peakRSSKiB();
+
+    WorkerTotals totals;
+    for (const auto& worker : workerTotals) {
+        for (int s = 0; s < StageCount; ++s) {
+            totals.stages[s].merge(worker.stages[s]);
+        }
+        totals.succeeded += worker.succeeded;
+        totals.failed += worker.failed;
+        totals.intervals += worker.intervals;
+    }
+
+    const long long skus = totals.succeeded + totals.failed;
+    std::cout << "*** Load test ***" << std::endl;
+    std::cout << "SKUs: " << skus << " (" << totals.succeeded << " ok, " << totals.failed << " failed) on " << threads
+              << " threads, " << config.numberOfIterations << " iterations, " << config.daysToSimulate << " days" << std::endl;
+    std::cout << "Time: " << seconds << " seconds" << std::endl;
+    std::cout << "Throughput: " << skus / std::max(seconds, 1e-9) << " SKUs/second, "
+              << totals.intervals / std::max(seconds, 1e-9) << " intervals/second" << std::endl;
+    std::cout << "Peak RSS: " << peakRSS / 1024.0 << " MiB (" << startRSS / 1024.0 << " MiB before the first SKU)" << std::endl;
+    std::printf("\n  %-10s %10s %12s %12s %12s %12s %12s\n", "stage (ms)", "count", "mean", "p50", "p90", "p99", "max");
+    for (int s = 0; s < StageCount; ++s) {
+        if (totals.stages[s].size() > 0) {
+            printStage(STAGE_NAMES[s], totals.stages[s]);
+        }
+    }
+    std::fflush(stdout);
+
+    if (!settings.jsonPath.empty()) {
+        if (!writeJSON(settings.jsonPath, settings, config, totals, threads, seconds, startRSS, peakRSS)) {
+            std::cerr << "Could not write " << settings.jsonPath << std::endl;
+            return 1;
+        }
+        std::cout << "Results saved in " << settings.jsonPath << std::endl;
+    }
+    return totals.failed == 0 ? 0 : 2;
+}